@@ -0,0 +1,23 @@
+#include <rsl/test>
+#include <numeric>
+#include <vector>
+
+namespace demo::benchmarks {
+
+[[=rsl::benchmark]]
+void accumulate() {
+  std::vector<int> values(1024, 1);
+  auto sum = std::accumulate(values.begin(), values.end(), 0);
+  rsl::testing::do_not_optimize(sum);
+  ASSERT(sum == 1024);
+}
+
+[[=rsl::benchmark]]
+void push_back() {
+  std::vector<int> values;
+  for (int idx = 0; idx < 256; ++idx) {
+    values.push_back(idx);
+  }
+  rsl::testing::clobber_memory();
+}
+}  // namespace demo::benchmarks
@@ -0,0 +1,60 @@
+#include <rsl/test>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace demo::fuzzing {
+struct KeyValue {
+  std::string_view key;
+  std::string_view value;
+};
+
+std::optional<KeyValue> parse_key_value(std::string_view line) {
+  auto separator = line.find('=');
+  if (separator == std::string_view::npos || separator == 0) {
+    return std::nullopt;
+  }
+  return KeyValue{line.substr(0, separator), line.substr(separator + 1)};
+}
+
+[[=rsl::fuzz]]
+void key_value_roundtrip(std::string_view input) {
+  if (auto parsed = parse_key_value(input)) {
+    ASSERT(!parsed->key.empty());
+    ASSERT(parsed->key.size() + parsed->value.size() + 1 == input.size());
+  }
+}
+
+[[=rsl::fuzz]]
+void raw_bytes(std::span<std::uint8_t const> data) {
+  std::uint32_t checksum = 0;
+  for (auto byte : data) {
+    checksum = checksum * 31 + byte;
+  }
+  rsl::testing::do_not_optimize(checksum);
+}
+enum class Operation { Add, Remove, Clear };
+
+struct Command {
+  Operation operation;
+  [[=rsl::in_range(0, 15)]] int slot;
+  std::string label;
+};
+
+[[=rsl::fuzz]]
+void apply_commands(std::vector<Command> const& commands, bool reverse) {
+  std::vector<std::string> slots(16);
+  for (std::size_t idx = 0; idx < commands.size(); ++idx) {
+    auto const& command = commands[reverse ? commands.size() - idx - 1 : idx];
+    ASSERT(command.slot >= 0 && command.slot < 16);
+    switch (command.operation) {
+      case Operation::Add: slots[command.slot] = command.label; break;
+      case Operation::Remove: slots[command.slot].clear(); break;
+      case Operation::Clear: slots.assign(16, {}); break;
+    }
+  }
+}
+}  // namespace demo::fuzzing
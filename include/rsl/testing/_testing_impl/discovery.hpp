@@ -3,6 +3,7 @@
 #include <string_view>
 #include <cstddef>
 #include <set>
+#include <algorithm>
 
 #include <meta>
 
@@ -32,6 +33,15 @@ consteval TestDef make_test(std::meta::info R) {
   return extract<TestDef>(substitute(^^make_test_impl, {reflect_constant(R)}));
 }
 
+// rsl::test and all specialized test kinds such as rsl::fuzz or rsl::benchmark
+consteval bool is_test_annotation(std::meta::info annotation) {
+  return is_base_of_type(^^annotations::TestTag, remove_cvref(type_of(annotation)));
+}
+
+consteval bool is_test(std::meta::info R) {
+  return std::ranges::any_of(annotations_of(R), is_test_annotation);
+}
+
 consteval std::vector<TestDef> expand_class(std::meta::info class_r) {
   std::vector<TestDef> tests{};
 
@@ -39,8 +49,7 @@ consteval std::vector<TestDef> expand_class(std::meta::info class_r) {
     if (!has_identifier(member) || identifier_of(member)[0] == '_') {
       continue;
     }
-    if ((is_function(member) || is_variable(member)) &&
-        has_annotation<annotations::TestTag>(member)) {
+    if ((is_function(member) || is_variable(member)) && is_test(member)) {
       tests.emplace_back(make_test(member));
     }
   }
@@ -62,7 +71,7 @@ struct TestDiscovery {
 
     auto annotations = annotations_of(R);
     for (auto annotation : annotations) {
-      if (type_of(annotation) == ^^annotations::TestTag) {
+      if (is_test_annotation(annotation)) {
         if (is_complete_type(R) && is_class_type(R)) {
           tests.append_range(expand_class(R));
         } else {
@@ -1,9 +1,14 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <functional>
+#include <memory>
 #include <meta>
 #include <vector>
 #include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
 #include <rsl/assert>
 #include <rsl/repr>
@@ -13,38 +18,25 @@
 #include <rsl/testing/result.hpp>
 
 #include "fixture.hpp"
+#include "mutate.hpp"
 
 namespace rsl::testing::_testing_impl {
-template <std::meta::info R, std::meta::info Target>
-struct FuzzRunner {
-  static int run(uint8_t const* Data, size_t Size) {
-    // TODO
-    return 0;
-  }
-
-  // mutator must be able to consider domains
-  static size_t mutate(uint8_t* Data, size_t Size, size_t MaxSize, unsigned int Seed) {
-    // TODO
-    return 0;
-  }
-};
-
 template <typename TC, std::meta::info Def, std::meta::info Target>
 struct TestRunner {
   template <typename T>
-  static void run_one(T const& tuple) {
+  static decltype(auto) run_one(T const& tuple) {
     if constexpr (is_class_member(Def)) {
       auto fixture = [:parent_of(Def):]();
-      std::apply(fixture.[:Target:], tuple);
+      return std::apply(fixture.[:Target:], tuple);
     } else if constexpr (is_variable(Def)) {
-      std::apply([:Def:].[:Target:], tuple);
+      return std::apply([:Def:].[:Target:], tuple);
     } else {
-      std::apply([:Target:], tuple);
+      return std::apply([:Target:], tuple);
     }
   }
 
   template <typename... Ts>
-  static std::string get_name(std::tuple<Ts...> args) {
+  static std::string get_name(std::tuple<Ts...> const& args) {
     std::string name;
     if constexpr (is_variable(Def)) {
       name += identifier_of(Def);
@@ -71,9 +63,154 @@ struct TestRunner {
     return name;
   }
 
-  template <typename... Ts>
-  static TC bind(Test const* group, std::tuple<Ts...> args) {
-    return {group, std::bind_front(run_one<std::tuple<Ts...>>, args), get_name(args)};
+  template <typename T>
+  static void invoke(void const* args) {
+    run_one(*static_cast<T const*>(args));
+  }
+
+  template <typename T>
+  static std::string describe(void const* args) {
+    return get_name(*static_cast<T const*>(args));
+  }
+
+  // `args` must outlive the case
+  template <typename T>
+  static TC bind(Test const* group, T const& args) {
+    return {group, invoke<T>, describe<T>, &args};
+  }
+};
+
+template <typename T>
+T decode_bytes(std::uint8_t const* data, std::size_t size) {
+  if constexpr (std::is_constructible_v<T, std::uint8_t const*, std::size_t>) {
+    // std::span<std::uint8_t const>
+    return T(data, size);
+  } else if constexpr (std::is_constructible_v<T, char const*, std::size_t>) {
+    // std::string_view, std::string
+    return T(reinterpret_cast<char const*>(data), size);
+  } else {
+    static_assert(false, "unsupported fuzz target parameter");
+  }
+}
+
+struct CorpusInput {
+  std::string id;  // file name
+  std::vector<std::uint8_t> data;
+};
+
+// inputs that made a fuzz target fail in previous runs, see src/corpus.cpp
+std::vector<CorpusInput> load_crashes(Test const* test, std::string_view case_name);
+
+// raw fuzz targets take their input as std::span<std::uint8_t const>, std::string_view,
+// std::string or as pointer and size
+consteval bool is_raw_fuzz_target(std::meta::info target) {
+  auto params = parameters_of(target);
+  if (params.size() == 2) {
+    return is_pointer_type(remove_cvref(type_of(params[0])));
+  }
+  if (params.size() != 1) {
+    return false;
+  }
+  auto type = remove_cvref(type_of(params[0]));
+  return is_constructible_type(type, {^^std::uint8_t const*, ^^std::size_t}) ||
+         is_constructible_type(type, {^^char const*, ^^std::size_t});
+}
+
+consteval std::meta::info fuzz_arguments(std::meta::info target) {
+  std::vector<std::meta::info> types;
+  for (auto param : parameters_of(target)) {
+    types.push_back(remove_cvref(type_of(param)));
+  }
+  return substitute(^^std::tuple, types);
+}
+
+// all other targets get typed arguments decoded from the input, see mutate.hpp
+template <std::meta::info R, std::meta::info Target>
+struct FuzzRunner {
+  using invoker   = TestRunner<void, R, Target>;
+  using arguments = [:fuzz_arguments(Target):];
+
+  static constexpr bool raw = is_raw_fuzz_target(Target);
+
+  static arguments decode(uint8_t const* Data, size_t Size) {
+    auto in = ByteReader(Data, Size);
+    return decode_value<arguments>(in);
+  }
+
+  // like libFuzzer, targets returning int may return -1 to keep an input out of the corpus
+  template <typename F>
+  static int status_of(F const& fnc) {
+    if constexpr (std::is_same_v<std::invoke_result_t<F const&>, int>) {
+      return fnc();
+    } else {
+      fnc();
+      return 0;
+    }
+  }
+
+  static int run(uint8_t const* Data, size_t Size) {
+    if constexpr (!raw) {
+      return status_of([&] { return invoker::run_one(decode(Data, Size)); });
+    } else if constexpr (parameters_of(Target).size() == 2) {
+      return status_of([&] { return invoker::run_one(std::tuple{Data, Size}); });
+    } else {
+      using input_type = std::tuple_element_t<0, arguments>;
+      return status_of(
+          [&] { return invoker::run_one(std::tuple{decode_bytes<input_type>(Data, Size)}); });
+    }
+  }
+
+  static size_t mutate(uint8_t* Data, size_t Size, size_t MaxSize, unsigned int Seed) {
+    if constexpr (raw) {
+      return mutate_bytes(Data, Size, MaxSize, Seed);
+    } else {
+      // mutate the decoded values so they stay within their domains
+      auto rng  = FuzzRng(Seed);
+      auto args = decode(Data, Size);
+      mutate_value(args, rng, MaxSize);
+
+      auto out = ByteWriter(Data, MaxSize);
+      encode_value(out, args);
+      return out.size();
+    }
+  }
+
+  // human readable arguments for reports, raw inputs are shown as bytes instead
+  static std::string describe(uint8_t const* Data, size_t Size) {
+    if constexpr (raw) {
+      return {};
+    } else {
+      return invoker::get_name(decode(Data, Size));
+    }
+  }
+
+  // runs a single empty input, the fuzzing loop itself is driven by the runner
+  static void run_empty(void const*) {
+    static constexpr std::uint8_t empty[1]{};
+    run(empty, 0);
+  }
+
+  static std::string case_name(void const*) { return invoker::get_name(std::tuple{}); }
+
+  // an input that made the target fail in a previous run
+  struct Replay {
+    std::vector<std::uint8_t> input;
+    std::string id;  // corpus file name, names raw inputs
+  };
+
+  static void replay(void const* args) {
+    auto const& replay = *static_cast<Replay const*>(args);
+    run(replay.input.data(), replay.input.size());
+  }
+
+  static std::string replay_name(void const* args) {
+    auto const& replay = *static_cast<Replay const*>(args);
+    auto name          = describe(replay.input.data(), replay.input.size());
+    if (name.empty()) {
+      name = invoker::get_name(std::tuple{});
+      name.insert(name.size() - 1, replay.id);
+    }
+    return name;
   }
 };
 
@@ -81,18 +218,29 @@ template <typename TC, std::meta::info R, _testing_impl::Annotations A>
 struct Expand {
   std::vector<TC> runs;
   Test const* group;
+  // arguments computed at runtime, one entry per generator rather than per case
+  std::vector<std::shared_ptr<void const>> storage;
+
+  template <typename T>
+  T const& keep(T value) {
+    auto stored = std::make_shared<T const>(std::move(value));
+    storage.push_back(stored);
+    return *stored;
+  }
 
   template <typename Runner, annotations::Params Generator>
   void expand_param_generator() {
     if constexpr (Generator.runtime) {
-      for (auto&& args : [:Generator.value:]()) {
+      auto const& sets = keep([:Generator.value:]());
+      runs.reserve(runs.size() + sets.size());
+      for (auto const& args : sets) {
         runs.push_back(Runner::bind(group, args));
       }
     } else {
       template for (constexpr auto set : [:Generator.value:]) {
         constexpr static auto args = set.value;
         // TODO use p2686/p1061 variadic constexpr structured binding instead
-        auto arg_tuple = []<std::size_t... Idx>(std::index_sequence<Idx...>) {
+        constexpr static auto arg_tuple = []<std::size_t... Idx>(std::index_sequence<Idx...>) {
           return std::make_tuple([:args[Idx]:]...);
         }(std::make_index_sequence<set.value.size()>());
 
@@ -105,9 +253,24 @@ struct Expand {
   void expand_params() {
     using runner = TestRunner<TC, R, Target>;
 
-    if constexpr (A.params.size() == 0) {
+    if constexpr (A.is_fuzz_test) {
+      using fuzzer = FuzzRunner<R, Target>;
+      using replay = typename fuzzer::Replay;
+
+      // replay past failures as ordinary cases before fuzzing for new ones
+      for (auto& crash : load_crashes(group, runner::get_name(std::tuple{}))) {
+        auto const& input = keep(replay{std::move(crash.data), std::move(crash.id)});
+        runs.push_back({group, fuzzer::replay, fuzzer::replay_name, &input});
+      }
+
+      runs.push_back({group,
+                      fuzzer::run_empty,
+                      fuzzer::case_name,
+                      nullptr,
+                      {group, fuzzer::run, fuzzer::mutate, fuzzer::describe}});
+    } else if constexpr (A.params.size() == 0) {
       // expand fixtures
-      runs.push_back(runner::bind(group, rsl::testing::_testing_impl::evaluate_fixtures<Target>()));
+      runs.push_back(runner::bind(group, keep(evaluate_fixtures<Target>())));
     } else {
       // expand param annotations
       template for (constexpr auto generator : A.params) {
@@ -0,0 +1,422 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <meta>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <rsl/testing/annotations.hpp>
+
+//? typed fuzz inputs are still stored as bytes, so the corpus, crossover and crash reports
+//? do not need to know about types. Decoding is total: every byte string decodes to a valid
+//? value and missing bytes read as zero, so no execution is wasted on undecodable inputs.
+//? Mutation decodes, mutates the typed values within their domain and encodes again.
+
+namespace rsl::testing::_testing_impl {
+// generic byte level mutation, see src/fuzz.cpp
+std::size_t mutate_bytes(std::uint8_t* data, std::size_t size, std::size_t max_size, unsigned seed);
+
+using FuzzRng = std::minstd_rand;
+
+struct Domain {
+  bool bounded     = false;
+  std::int64_t min = 0;
+  std::int64_t max = 0;
+};
+
+consteval Domain domain_of(std::meta::info member) {
+  auto ranges = annotations_of(member, ^^annotations::InRange);
+  if (ranges.empty()) {
+    return {};
+  }
+  auto range = extract<annotations::InRange>(constant_of(ranges[0]));
+  return {true, range.min, range.max};
+}
+
+consteval bool is_instance_of(std::meta::info type, std::meta::info templ) {
+  type = dealias(type);
+  return has_template_arguments(type) && template_of(type) == templ;
+}
+
+template <typename T>
+consteval bool is_tuple_like() {
+  return is_instance_of(^^T, ^^std::tuple) || is_instance_of(^^T, ^^std::pair) ||
+         is_instance_of(^^T, ^^std::array);
+}
+
+template <typename T>
+consteval auto enumerator_values() {
+  std::vector<T> values;
+  for (auto enumerator : enumerators_of(^^T)) {
+    values.push_back(extract<T>(enumerator));
+  }
+  return std::define_static_array(values);
+}
+
+template <typename T>
+consteval auto data_members() {
+  return std::define_static_array(
+      nonstatic_data_members_of(^^T, std::meta::access_context::current()));
+}
+
+class ByteReader {
+  std::uint8_t const* data;
+  std::size_t size;
+
+public:
+  ByteReader(std::uint8_t const* data, std::size_t size) : data(data), size(size) {}
+
+  template <typename T>
+  T read() {
+    T value{};
+    auto count = std::min(sizeof(T), size);
+    std::memcpy(&value, data, count);
+    data += count;
+    size -= count;
+    return value;
+  }
+
+  void read(void* target, std::size_t count) {
+    count = std::min(count, size);
+    std::memcpy(target, data, count);
+    data += count;
+    size -= count;
+  }
+
+  // LEB128
+  std::uint64_t read_varint() {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64 && size != 0; shift += 7) {
+      auto byte = read<std::uint8_t>();
+      value |= std::uint64_t(byte & 0x7fU) << shift;
+      if ((byte & 0x80U) == 0) {
+        break;
+      }
+    }
+    return value;
+  }
+
+  [[nodiscard]] std::size_t remaining() const { return size; }
+};
+
+class ByteWriter {
+  std::uint8_t* data;
+  std::size_t capacity;
+  std::size_t used = 0;
+
+public:
+  ByteWriter(std::uint8_t* data, std::size_t capacity) : data(data), capacity(capacity) {}
+
+  // anything beyond the capacity is cut off, the truncated input still decodes
+  void write(void const* source, std::size_t count) {
+    count = std::min(count, capacity - used);
+    std::memcpy(data + used, source, count);
+    used += count;
+  }
+
+  template <typename T>
+  void write(T const& value) {
+    write(&value, sizeof(T));
+  }
+
+  void write_varint(std::uint64_t value) {
+    do {
+      auto byte = std::uint8_t(value & 0x7fU);
+      value >>= 7U;
+      write(std::uint8_t(value != 0 ? byte | 0x80U : byte));
+    } while (value != 0);
+  }
+
+  [[nodiscard]] std::size_t size() const { return used; }
+};
+
+template <std::integral T>
+T to_domain(T value, Domain domain) {
+  // wraps `value` into [min, max], the span is 0 if the domain covers all of std::uint64_t
+  auto span   = std::uint64_t(domain.max) - std::uint64_t(domain.min) + 1;
+  auto offset = std::uint64_t(value) - std::uint64_t(domain.min);
+  return T(std::uint64_t(domain.min) + (span == 0 ? offset : offset % span));
+}
+
+// number of elements of a string or container, bounded by the domain or by the remaining input
+template <Domain D>
+std::size_t decode_length(ByteReader& in) {
+  auto raw = in.read_varint();
+  if constexpr (D.bounded) {
+    return std::size_t(to_domain<std::int64_t>(std::int64_t(raw) + D.min, D));
+  } else {
+    return std::size_t(std::min<std::uint64_t>(raw, in.remaining()));
+  }
+}
+
+template <Domain D>
+void encode_length(ByteWriter& out, std::size_t length) {
+  if constexpr (D.bounded) {
+    out.write_varint(std::uint64_t(std::int64_t(length) - D.min));
+  } else {
+    out.write_varint(length);
+  }
+}
+
+template <Domain D>
+std::size_t max_length(std::size_t max_size) {
+  if constexpr (D.bounded) {
+    // a wide range must not grow inputs past the configured size, its minimum still holds
+    return std::max(std::size_t(D.min), std::min(std::size_t(D.max), max_size));
+  } else {
+    return max_size;
+  }
+}
+
+template <typename T, Domain D = {}>
+T decode_value(ByteReader& in) {
+  if constexpr (std::same_as<T, bool>) {
+    return (in.read<std::uint8_t>() & 1U) != 0;
+  } else if constexpr (std::is_enum_v<T>) {
+    constexpr static auto values = enumerator_values<T>();
+    if constexpr (values.size() == 0) {
+      return T(in.read<std::underlying_type_t<T>>());
+    } else {
+      return values[in.read<std::uint16_t>() % values.size()];
+    }
+  } else if constexpr (std::is_integral_v<T>) {
+    if constexpr (D.bounded) {
+      return to_domain(T(in.read<T>() + D.min), D);
+    } else {
+      return in.read<T>();
+    }
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return in.read<T>();
+  } else if constexpr (is_instance_of(^^T, ^^std::basic_string)) {
+    T value(decode_length<D>(in), typename T::value_type{});
+    in.read(value.data(), value.size() * sizeof(typename T::value_type));
+    return value;
+  } else if constexpr (is_instance_of(^^T, ^^std::vector)) {
+    T value;
+    auto length = decode_length<D>(in);
+    value.reserve(length);
+    for (std::size_t idx = 0; idx < length; ++idx) {
+      value.push_back(decode_value<typename T::value_type>(in));
+    }
+    return value;
+  } else if constexpr (is_instance_of(^^T, ^^std::optional)) {
+    if ((in.read<std::uint8_t>() & 1U) == 0) {
+      return T{};
+    }
+    return T{decode_value<typename T::value_type, D>(in)};
+  } else if constexpr (is_tuple_like<T>()) {
+    // braced initialization guarantees left to right evaluation
+    return [&]<std::size_t... Idx>(std::index_sequence<Idx...>) {
+      return T{decode_value<std::tuple_element_t<Idx, T>>(in)...};
+    }(std::make_index_sequence<std::tuple_size_v<T>>());
+  } else if constexpr (std::is_aggregate_v<T>) {
+    T value{};
+    template for (constexpr auto member : data_members<T>()) {
+      value.[:member:] = decode_value<[:remove_cvref(type_of(member)):], domain_of(member)>(in);
+    }
+    return value;
+  } else {
+    static_assert(false, "unsupported fuzz target parameter type");
+  }
+}
+
+template <typename T, Domain D = {}>
+void encode_value(ByteWriter& out, T const& value) {
+  if constexpr (std::same_as<T, bool>) {
+    out.write(std::uint8_t(value));
+  } else if constexpr (std::is_enum_v<T>) {
+    constexpr static auto values = enumerator_values<T>();
+    if constexpr (values.size() == 0) {
+      out.write(std::to_underlying(value));
+    } else {
+      auto it = std::ranges::find(values, value);
+      out.write(std::uint16_t(it == values.end() ? 0 : it - values.begin()));
+    }
+  } else if constexpr (std::is_integral_v<T>) {
+    if constexpr (D.bounded) {
+      out.write(T(value - D.min));
+    } else {
+      out.write(value);
+    }
+  } else if constexpr (std::is_floating_point_v<T>) {
+    out.write(value);
+  } else if constexpr (is_instance_of(^^T, ^^std::basic_string)) {
+    encode_length<D>(out, value.size());
+    out.write(value.data(), value.size() * sizeof(typename T::value_type));
+  } else if constexpr (is_instance_of(^^T, ^^std::vector)) {
+    encode_length<D>(out, value.size());
+    for (auto const& element : value) {
+      encode_value(out, element);
+    }
+  } else if constexpr (is_instance_of(^^T, ^^std::optional)) {
+    out.write(std::uint8_t(value.has_value()));
+    if (value) {
+      encode_value<typename T::value_type, D>(out, *value);
+    }
+  } else if constexpr (is_tuple_like<T>()) {
+    std::apply([&](auto const&... elements) { (encode_value(out, elements), ...); }, value);
+  } else if constexpr (std::is_aggregate_v<T>) {
+    template for (constexpr auto member : data_members<T>()) {
+      encode_value<[:remove_cvref(type_of(member)):], domain_of(member)>(out, value.[:member:]);
+    }
+  } else {
+    static_assert(false, "unsupported fuzz target parameter type");
+  }
+}
+
+template <std::integral T, Domain D>
+void mutate_integer(T& value, FuzzRng& rng) {
+  using limits = std::numeric_limits<T>;
+  switch (rng() % 4) {
+    case 0: value = T(value + T(1 + rng() % 16)); break;
+    case 1: value = T(value - T(1 + rng() % 16)); break;
+    case 2: value = T(value ^ T(T(1) << (rng() % limits::digits))); break;
+    default: {
+      // boundaries of the domain are the most likely to be mishandled
+      auto const candidates = D.bounded ? std::array{T(D.min), T(D.max), T(D.min + 1), T(D.max - 1)}
+                                        : std::array{T(0), T(1), limits::min(), limits::max()};
+      value = candidates[rng() % candidates.size()];
+    }
+  }
+  if constexpr (D.bounded) {
+    value = to_domain(value, D);
+  }
+}
+
+template <std::floating_point T>
+void mutate_float(T& value, FuzzRng& rng) {
+  using limits = std::numeric_limits<T>;
+  constexpr auto special = std::array{T(0),
+                                      -T(0),
+                                      T(1),
+                                      T(-1),
+                                      limits::min(),
+                                      limits::max(),
+                                      limits::lowest(),
+                                      limits::epsilon(),
+                                      limits::denorm_min(),
+                                      limits::infinity(),
+                                      -limits::infinity(),
+                                      limits::quiet_NaN()};
+  switch (rng() % 4) {
+    case 0: value += T(rng() % 201) / T(100) - T(1); break;
+    case 1: value = rng() % 2 == 0 ? value * T(2) : value / T(2); break;
+    case 2: value = -value; break;
+    default: value = special[rng() % special.size()];
+  }
+}
+
+template <typename T, Domain D = {}>
+void mutate_value(T& value, FuzzRng& rng, std::size_t max_size);
+
+template <typename T, Domain D>
+void mutate_string(T& value, FuzzRng& rng, std::size_t max_size) {
+  using char_type  = typename T::value_type;
+  auto const limit = std::max(max_length<D>(max_size / sizeof(char_type)), std::size_t{1});
+  auto old_size    = std::min(value.size(), limit);
+
+  value.resize(limit);
+  auto* bytes = reinterpret_cast<std::uint8_t*>(value.data());
+  auto size   = mutate_bytes(bytes, old_size * sizeof(char_type), limit * sizeof(char_type), rng());
+  value.resize(size / sizeof(char_type));
+  if constexpr (D.bounded) {
+    value.resize(std::max(value.size(), std::size_t(D.min)));
+  }
+}
+
+template <typename T, Domain D>
+void mutate_vector(T& value, FuzzRng& rng, std::size_t max_size) {
+  auto const limit = max_length<D>(max_size);
+  auto const min   = D.bounded ? std::size_t(D.min) : std::size_t{0};
+
+  switch (value.empty() ? 0 : rng() % 4) {
+    case 0:
+      if (value.size() < limit) {
+        auto pos = value.begin() + std::ptrdiff_t(rng() % (value.size() + 1));
+        mutate_value(*value.emplace(pos), rng, max_size);
+        return;
+      }
+      [[fallthrough]];
+    case 1:
+      if (value.size() > min) {
+        value.erase(value.begin() + std::ptrdiff_t(rng() % value.size()));
+        return;
+      }
+      [[fallthrough]];
+    case 2:
+      if (!value.empty()) {
+        std::swap(value[rng() % value.size()], value[rng() % value.size()]);
+      }
+      [[fallthrough]];
+    default:
+      if (!value.empty()) {
+        mutate_value(value[rng() % value.size()], rng, max_size);
+      }
+  }
+}
+
+template <typename T, Domain D>
+void mutate_value(T& value, FuzzRng& rng, std::size_t max_size) {
+  if constexpr (std::same_as<T, bool>) {
+    value = !value;
+  } else if constexpr (std::is_enum_v<T>) {
+    constexpr static auto values = enumerator_values<T>();
+    if constexpr (values.size() == 0) {
+      auto raw = std::to_underlying(value);
+      mutate_integer<decltype(raw), Domain{}>(raw, rng);
+      value = T(raw);
+    } else {
+      value = values[rng() % values.size()];
+    }
+  } else if constexpr (std::is_integral_v<T>) {
+    mutate_integer<T, D>(value, rng);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    mutate_float(value, rng);
+  } else if constexpr (is_instance_of(^^T, ^^std::basic_string)) {
+    mutate_string<T, D>(value, rng, max_size);
+  } else if constexpr (is_instance_of(^^T, ^^std::vector)) {
+    mutate_vector<T, D>(value, rng, max_size);
+  } else if constexpr (is_instance_of(^^T, ^^std::optional)) {
+    if (!value) {
+      mutate_value<typename T::value_type, D>(value.emplace(), rng, max_size);
+    } else if (rng() % 4 == 0) {
+      value.reset();
+    } else {
+      mutate_value<typename T::value_type, D>(*value, rng, max_size);
+    }
+  } else if constexpr (is_tuple_like<T>()) {
+    if constexpr (std::tuple_size_v<T> != 0) {
+      [&]<std::size_t... Idx>(std::index_sequence<Idx...>) {
+        auto pick = rng() % sizeof...(Idx);
+        ((pick == Idx ? mutate_value(std::get<Idx>(value), rng, max_size) : void()), ...);
+      }(std::make_index_sequence<std::tuple_size_v<T>>());
+    }
+  } else if constexpr (std::is_aggregate_v<T>) {
+    constexpr static auto members = data_members<T>();
+    if constexpr (members.size() != 0) {
+      auto pick       = rng() % members.size();
+      std::size_t idx = 0;
+      template for (constexpr auto member : members) {
+        if (idx++ == pick) {
+          mutate_value<[:remove_cvref(type_of(member)):], domain_of(member)>(value.[:member:],
+                                                                             rng,
+                                                                             max_size);
+        }
+      }
+    }
+  } else {
+    static_assert(false, "unsupported fuzz target parameter type");
+  }
+}
+}  // namespace rsl::testing::_testing_impl
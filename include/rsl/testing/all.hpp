@@ -4,21 +4,29 @@
 #include <rsl/testing/assert.hpp>
 
 #include <rsl/testing/annotations.hpp>
+#include <rsl/testing/benchmark.hpp>
 #include <rsl/testing/test.hpp>
 #include <rsl/testing/util.hpp>
 
 #include <rsl/testing/_testing_impl/discovery.hpp>
 
 namespace rsl {
+using testing::benchmark;
 using testing::fixture;
 using testing::fuzz;
 using testing::test;
 
+using testing::clobber_memory;
+using testing::do_not_optimize;
+
 using testing::params;
 using testing::tparams;
 
 using testing::expect_failure;
+using testing::in_range;
+using testing::max_allocations;
 using testing::rename;
+using testing::serial;
 using testing::skip;
 using testing::skip_if;
 
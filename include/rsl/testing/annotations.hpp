@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <vector>
 #include <initializer_list>
 #include <meta>
@@ -20,9 +23,11 @@ struct FixtureTag {};
 // test kinds
 struct TestTag {};
 struct FuzzTag : TestTag {};
+struct BenchmarkTag : TestTag {};
 
 // flags
 struct ExpectFailureTag {};
+struct SerialTag {};
 
 struct Skip {
   bool (*value)() = &_testing_impl::constant_predicate<true>;
@@ -61,6 +66,25 @@ struct Rename {
   }
 };
 
+// value domain of a fuzzed data member
+// bounds integers, or the length of strings and containers
+struct InRange {
+  std::int64_t min = 0;
+  std::int64_t max = 0;
+
+  static consteval InRange operator()(std::int64_t min, std::int64_t max) {
+    constexpr_assert(min <= max, "in_range requires min <= max");
+    return {min, max};
+  }
+};
+
+// fail a test case that allocates more often than this, only checked with rsltest_alloc
+struct MaxAllocations {
+  std::size_t value = 0;
+
+  static consteval MaxAllocations operator()(std::size_t limit) { return {limit}; }
+};
+
 // parameterization
 struct TParams {
   rsl::span<ParamSet const> value;
@@ -97,11 +121,15 @@ constexpr inline annotations::FixtureTag fixture;
 
 constexpr inline annotations::TestTag test;
 constexpr inline annotations::FuzzTag fuzz;
+constexpr inline annotations::BenchmarkTag benchmark;
 
 constexpr inline annotations::ExpectFailureTag expect_failure;
+constexpr inline annotations::SerialTag serial;
 constexpr inline annotations::Skip skip;
 constexpr inline annotations::SkipIf skip_if;
 constexpr inline annotations::Rename rename;
+constexpr inline annotations::InRange in_range;
+constexpr inline annotations::MaxAllocations max_allocations;
 
 using tparams = annotations::TParams;
 using params  = annotations::Params;
@@ -115,6 +143,10 @@ struct Annotations {  // consteval-only
   bool (*skip)()      = nullptr;  // this is a function to support conditional skipping
   rsl::string_view name;          // custom base name
   bool is_fuzz_test = false;
+  bool is_benchmark = false;
+  bool serial       = false;  // must not run concurrently with other tests
+
+  std::size_t max_allocations = std::numeric_limits<std::size_t>::max();
 
   consteval explicit Annotations(std::meta::info fnc) {
     std::vector<ParamSet> tp_sets;
@@ -136,7 +168,17 @@ struct Annotations {  // consteval-only
         constexpr_assert(name.empty(), "Cannot rename more than once.");
         name = extract<annotations::Rename>(constant_of(annotation)).value;
       } else if (type == ^^annotations::FuzzTag) {
+        // coverage feedback is process-wide state
         is_fuzz_test = true;
+        serial       = true;
+      } else if (type == ^^annotations::BenchmarkTag) {
+        // measurements are meaningless with other tests competing for the CPU
+        is_benchmark = true;
+        serial       = true;
+      } else if (type == ^^annotations::SerialTag) {
+        serial = true;
+      } else if (type == ^^annotations::MaxAllocations) {
+        max_allocations = extract<annotations::MaxAllocations>(constant_of(annotation)).value;
       }
     }
 
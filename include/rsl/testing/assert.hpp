@@ -1,6 +1,11 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <optional>
+#include <string>
 #include <vector>
 #include <string_view>
 
@@ -8,13 +13,37 @@
 
 namespace rsl::testing {
 
+struct AssertionDiagnostic {
+  std::string expression;
+  std::string value;
+};
+
+//? the failure handler only copies what libassert already computed
+//? formatting and symbolizing the trace are deferred until a reporter asks for `message()`
 struct assertion_failure : std::exception {
-  std::string message;
   rsl::source_location sloc;
 
+  std::string_view action;     // "Assertion failed" etc.
+  std::string_view macro;      // ASSERT, ASSERT_EQ, ...
+  std::string_view expression;
+  std::string note;                               // optional user supplied message
+  std::vector<AssertionDiagnostic> diagnostics;  // operands and extra diagnostics
+  std::vector<std::uintptr_t> trace;             // raw return addresses, innermost first
+  std::string test_name;                         // trace is cut off at this frame
+  mutable std::optional<std::string> formatted;  // cache for `message()`
+
+  explicit assertion_failure(rsl::source_location sloc) : sloc(sloc) {}
   assertion_failure(std::string_view message, rsl::source_location sloc)
-      : message(std::string(message))
-      , sloc(sloc) {}
+      : sloc(sloc)
+      , formatted(std::string(message)) {}
+
+  // formats the failure on first use, not synchronized
+  [[nodiscard]] std::string const& message() const;
+
+  // never formats, code logging caught exceptions must not pay for symbolizing the trace
+  [[nodiscard]] char const* what() const noexcept override {
+    return formatted ? formatted->c_str() : "assertion failed, see message()";
+  }
 };
   
 struct AssertionInfo {
@@ -22,10 +51,131 @@ struct AssertionInfo {
   std::string_view expanded;
   bool success;
 };
+
+enum class AssertionTracking : std::uint8_t {
+  all,       // keep every assertion
+  failures,  // keep failed assertions only
+  last,      // keep the most recent `AssertionSettings::limit` assertions
+  count      // only count assertions
+};
+
+struct AssertionSettings {
+  AssertionTracking mode = AssertionTracking::all;
+  std::size_t limit      = 64;
+  bool sites             = false;  // count outcomes per ASSERT across the run, see AssertionSite
+};
+
 namespace _testing_impl {
+AssertionSettings& assertion_settings();
+
+//? every ASSERT owns a constant initialized site, so reaching one costs nothing up front
+//? sites are only counted and linked into the process-wide list if `AssertionSettings::sites`
+struct AssertionSite {
+  char const* expression;
+  char const* file;
+  unsigned line;
+  std::atomic<std::size_t> passed{0};
+  std::atomic<std::size_t> failed{0};
+  std::atomic<bool> linked{false};
+  AssertionSite const* next = nullptr;
+
+  constexpr AssertionSite(char const* expression, char const* file, unsigned line)
+      : expression(expression)
+      , file(file)
+      , line(line) {}
+
+  void count(bool success);
+};
+
+// all sites counted so far, most recently reached first
+AssertionSite const* assertion_sites();
+
+//? one tracker per thread, assertion-heavy loops only pay for thread-local increments
+//? unless the selected mode keeps assertions around
 struct AssertionTracker {
   std::vector<AssertionInfo> assertions;
   std::string test_name;
+  AssertionSettings settings;
+  std::size_t passed = 0;
+  std::size_t failed = 0;
+
+  // failures of soft assertions, the test keeps running after these
+  std::vector<assertion_failure> failures;
+  bool soft = false;  // set right before a failing CHECK reaches the failure handler
+
+  //? every failure is kept, but a CHECK failing in a loop would keep a raw trace per iteration
+  //? only the first few failures of a site keep theirs, message and diagnostics are kept anyway
+  static constexpr std::size_t traces_per_site = 8;
+  struct SiteFailures {
+    std::string_view file;
+    std::uint_least32_t line;
+    std::size_t count;
+  };
+  std::vector<SiteFailures> sites;  // soft failures so far per CHECK
+
+  void record(AssertionSite& site, bool success) {
+    ++(success ? passed : failed);
+    if (settings.sites) [[unlikely]] {
+      site.count(success);
+    }
+
+    auto const* expression = site.expression;
+    switch (settings.mode) {
+      using enum AssertionTracking;
+      case all: keep({expression, "", success}); break;
+      case failures:
+        if (!success) {
+          keep({expression, "", success});
+        }
+        break;
+      case last:
+        if (assertions.size() < settings.limit) {
+          keep({expression, "", success});
+        } else if (settings.limit != 0) {
+          assertions[(passed + failed - 1) % settings.limit] = {expression, "", success};
+        }
+        break;
+      case count: break;
+    }
+  }
+
+  void keep(AssertionInfo info) {
+    if (assertions.size() == assertions.capacity()) [[unlikely]] {
+      grow();
+    }
+    assertions.push_back(info);
+  }
+
+  // storage for assertions never counts towards the allocations of the test
+  void grow();
+
+  void clear() {
+    assertions.clear();
+    failures.clear();
+    sites.clear();
+    passed = 0;
+    failed = 0;
+  }
+
+  // turns the first soft failure into a hard one, for callers that stop at the first failure
+  void raise() {
+    if (!failures.empty()) {
+      auto failure = std::move(failures.front());
+      failures.clear();
+      throw failure;
+    }
+  }
+
+  // recorded assertions in the order they were made
+  std::vector<AssertionInfo> take() {
+    auto total = passed + failed;
+    if (settings.mode == AssertionTracking::last && settings.limit != 0 &&
+        total > assertions.size()) {
+      // oldest entry of the ring buffer first
+      std::ranges::rotate(assertions, assertions.begin() + std::ptrdiff_t(total % settings.limit));
+    }
+    return std::move(assertions);
+  }
 };
 
 AssertionTracker& assertion_counter();
@@ -40,9 +190,11 @@ AssertionTracker& assertion_counter();
                                    condition_value,                                            \
                                    pretty_function_arg,                                        \
                                    ...)                                                        \
-  rsl::testing::_testing_impl::assertion_counter().assertions.emplace_back(#expr,              \
-                                                                           "",                 \
-                                                                           (condition_value)); \
+  static constinit rsl::testing::_testing_impl::AssertionSite _rsl_assertion_site(#expr,       \
+                                                                                  __FILE__,    \
+                                                                                  __LINE__);   \
+  rsl::testing::_testing_impl::assertion_counter().record(_rsl_assertion_site,                 \
+                                                          (condition_value));                  \
   if (LIBASSERT_STRONG_EXPECT(!(condition_value), 0)) {                                        \
     libassert::ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT();                                 \
     LIBASSERT_BREAKPOINT_IF_DEBUGGING_ON_FAIL();                                               \
@@ -53,4 +205,21 @@ AssertionTracker& assertion_counter();
                                                pretty_function_arg);                           \
   }
 #define LIBASSERT_BREAK_ON_FAIL
-#include <libassert/assert.hpp>
\ No newline at end of file
+#include <libassert/assert.hpp>
+
+// soft assertions record their failure and let the test continue
+// the test fails once it returns, reporting every failure
+#define RSL_TESTING_SOFT_ASSERT(expr, name, ...)                                               \
+  LIBASSERT_INVOKE(expr,                                                                       \
+                   name,                                                                       \
+                   assertion,                                                                  \
+                   rsl::testing::_testing_impl::assertion_counter().soft = true,               \
+                   __VA_ARGS__)
+#define RSL_CHECK(expr, ...)  RSL_TESTING_SOFT_ASSERT(expr, "RSL_CHECK", __VA_ARGS__)
+#define RSL_EXPECT(expr, ...) RSL_TESTING_SOFT_ASSERT(expr, "RSL_EXPECT", __VA_ARGS__)
+
+// the short names collide with Catch2, doctest and glog, so they are opt-in
+#ifdef RSLTEST_SHORT_CHECKS
+#  define CHECK(expr, ...)  RSL_TESTING_SOFT_ASSERT(expr, "CHECK", __VA_ARGS__)
+#  define EXPECT(expr, ...) RSL_TESTING_SOFT_ASSERT(expr, "EXPECT", __VA_ARGS__)
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace rsl::testing {
+// forces `value` to be materialized, the computation producing it cannot be removed
+template <typename T>
+inline void do_not_optimize(T const& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+  asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+// forces all pending writes to memory to be considered observable
+inline void clobber_memory() {
+  asm volatile("" : : : "memory");
+}
+}  // namespace rsl::testing
@@ -11,6 +11,9 @@ namespace rsl::testing {
 struct Output {
   virtual ~Output()                        = default;
   virtual void print(std::string_view str) = 0;
+  virtual void flush() {}
+  // whether lines may be redrawn in place
+  [[nodiscard]] virtual bool is_terminal() const { return false; }
 
   template <typename... T>
   void printf(std::format_string<T...> fmt, T&&... args) {
@@ -21,7 +24,17 @@ struct Output {
 struct Reporter : _testing_impl::Factory<Reporter> {
   explicit Reporter(Key) {}
 
+protected:
+  // for reporters that cannot be selected by name, such as the fan-out in rsltest_main
+  Reporter() = default;
+
+public:
   virtual ~Reporter() = default;
+
+  // called before anything else, streaming reporters write to `output` as results arrive
+  // all other reporters only get their output in `finalize`
+  virtual void attach(Output& output) {}
+
   virtual void before_run(TestNamespace const& tests) {}
   virtual void after_run() {}
 
@@ -1,6 +1,9 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "assert.hpp"
 
@@ -22,24 +25,100 @@ struct FileCoverage {
   std::vector<LineCoverage> coverage;
 };
 
+struct BenchmarkResult {
+  std::size_t iterations = 0;  // per sample
+  std::size_t samples    = 0;
+
+  // time per iteration in nanoseconds
+  double min_ns    = 0;
+  double median_ns = 0;
+  double mean_ns   = 0;
+  double stddev_ns = 0;
+
+  [[nodiscard]] double throughput() const { return mean_ns == 0 ? 0 : 1e9 / mean_ns; }
+};
+
+struct FuzzResult {
+  std::size_t runs        = 0;
+  std::size_t corpus_size = 0;
+  std::size_t features    = 0;  // distinct coverage features reached, 0 without rsltest_cov
+  std::uint64_t seed      = 0;
+  double duration_ms      = 0;
+
+  std::vector<std::uint8_t> crash;  // input that made the target fail
+  std::string crash_arguments;      // `crash` decoded for typed fuzz targets
+  std::string crash_file;           // where `crash` was saved, empty without a corpus
+
+  [[nodiscard]] double execs_per_second() const {
+    return duration_ms == 0 ? 0 : double(runs) * 1e3 / duration_ms;
+  }
+};
+
+// heap usage of the thread running a test case, see rsltest_alloc
+struct AllocationResult {
+  std::size_t count = 0;  // allocations, reallocations included
+  std::size_t bytes = 0;  // allocated in total
+  std::size_t peak  = 0;  // highest live heap above the level at the start
+};
+
+// measured around the test body on the thread running it
+struct PerfResult {
+  // hardware counters, empty if perf events are not permitted or not supported
+  std::optional<std::uint64_t> cycles;
+  std::optional<std::uint64_t> instructions;
+  std::optional<std::uint64_t> cache_misses;
+  std::optional<std::uint64_t> branch_misses;
+
+  // from getrusage, Windows only reports CPU time
+  double user_ms                     = 0;
+  double system_ms                   = 0;
+  std::uint64_t minor_faults         = 0;
+  std::uint64_t major_faults         = 0;
+  std::uint64_t voluntary_switches   = 0;
+  std::uint64_t involuntary_switches = 0;
+
+  [[nodiscard]] double instructions_per_cycle() const {
+    return cycles && instructions && *cycles != 0 ? double(*instructions) / double(*cycles) : 0;
+  }
+};
+
 struct Result {
   class Test const* test;
-  std::string name;
+  std::string (*describe)(void const*) = nullptr;  // stringifies `args`, see `name()`
+  void const* args                      = nullptr;
+
+  // names are only built when a reporter asks for them
+  [[nodiscard]] std::string name() const { return describe == nullptr ? "" : describe(args); }
 
   TestOutcome outcome;
   double duration_ms;
 
-  std::optional<assertion_failure> failure;
+  // soft failures first, then at most one fatal, then a violated allocation limit
+  std::vector<assertion_failure> failures;
   std::string exception;
   std::string stdout;
   std::string stderr;
   
-  std::vector<AssertionInfo> assertions;
-  std::vector<FileCoverage> coverage;
+  std::vector<AssertionInfo> assertions;  // depending on RunConfig::assertion_tracking
+  std::size_t assertions_passed = 0;
+  std::size_t assertions_failed = 0;
+  std::vector<FileCoverage> coverage;  // moved into `run_coverage()` before reporters see it
+  std::optional<BenchmarkResult> benchmark;
+  std::optional<FuzzResult> fuzz;
+  std::optional<AllocationResult> allocations;  // only if rsltest_alloc is linked in
+  std::optional<PerfResult> counters;           // only with RunConfig::perf_counters
 };
 
 struct TestResult {
   class Test const* test;
   std::vector<Result> results;
 };
+
+// every line that carries coverage instrumentation, with a count of 0
+// empty unless rsltest_cov is linked in
+std::vector<FileCoverage> instrumented_lines();
+
+// coverage of every case run so far merged per line, including lines never reached
+// empty unless rsltest_cov is linked in
+std::vector<FileCoverage> run_coverage();
 }  // namespace rsl::testing
\ No newline at end of file
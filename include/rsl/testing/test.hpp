@@ -4,6 +4,8 @@
 #include <meta>
 #include <iterator>
 #include <deque>
+#include <limits>
+#include <span>
 
 #include "result.hpp"
 
@@ -14,28 +16,43 @@
 #include <rsl/testing/assert.hpp>
 
 namespace rsl::testing {
-struct TestCase {
-  class Test const* test;
-  std::function<void()> fnc;
-  std::string name;
-
-  [[nodiscard]] Result run() const;
-};
-
 struct FuzzTarget {
   // stringifying name is pointless here, perhaps do it after failure
   class Test const* test;
   int (*run)(uint8_t const*, size_t);
   size_t (*mutate)(uint8_t*, size_t, size_t, unsigned int);
+  std::string (*describe)(uint8_t const*, size_t);  // decoded arguments, empty for raw bytes
+};
+
+//? cases are plain function pointers and a pointer to their arguments so expanding
+//? large parameter sweeps does not allocate per case. Arguments of `params` sets are static
+//? data, all others are owned by the expansion of their test
+struct TestCase {
+  class Test const* test;
+  void (*fnc)(void const*);              // runs the test with `args`
+  std::string (*describe)(void const*);  // stringifies `args`
+  void const* args;
+  FuzzTarget fuzz{};  // only set for rsl::fuzz tests, `fnc` then runs a single empty input
+
+  // names are only built when needed, for most cases that is never
+  [[nodiscard]] std::string name() const { return describe(args); }
+  [[nodiscard]] Result run() const;
 };
 
 class Test {
-  using runner_type = std::vector<TestCase> (Test::*)() const;
+  using runner_type = std::span<TestCase const> (Test::*)() const;
   runner_type get_tests_impl;
 
   template <std::meta::info R, _testing_impl::Annotations Ann>
-  std::vector<TestCase> expand_test() const {
-    return _testing_impl::Expand<TestCase, R, Ann>{this}.runs;
+  std::span<TestCase const> expand_test() const {
+    //? tests in the tree are copies that filtering might destroy,
+    //? cases refer to a copy that lives as long as they do instead
+    //? the expansion is never rebuilt. Crash replays of fuzz tests are read from the
+    //? `fuzz_corpus` set when a test is first expanded, later runs in the same process
+    //? keep them even if they pass a different corpus
+    static Test const self      = *this;
+    static auto const expansion = _testing_impl::Expand<TestCase, R, Ann>{&self};
+    return expansion.runs;
   }
 
 public:
@@ -47,16 +64,23 @@ public:
   bool expect_failure;  // invert test checking
   bool (*skip)();       // function to support conditional skipping
   bool is_fuzz_test;
+  bool is_benchmark;
+  bool serial;          // never run concurrently with other tests
+
+  std::size_t max_allocations;  // per test case, only checked with rsltest_alloc
 
   Test() = delete;
   consteval explicit Test(std::meta::info test, std::meta::info annotation_anchor)
       : sloc(source_location_of(test))
       , name(define_static_string(identifier_of(test))) {
-    auto ann       = _testing_impl::Annotations(annotation_anchor);
-    preferred_name = ann.name;
-    expect_failure = ann.expect_failure;
-    skip           = ann.skip;
-    is_fuzz_test   = ann.is_fuzz_test;
+    auto ann        = _testing_impl::Annotations(annotation_anchor);
+    preferred_name  = ann.name;
+    expect_failure  = ann.expect_failure;
+    skip            = ann.skip;
+    is_fuzz_test    = ann.is_fuzz_test;
+    is_benchmark    = ann.is_benchmark;
+    serial          = ann.serial;
+    max_allocations = ann.max_allocations;
 
     get_tests_impl = extract<runner_type>(
         substitute(^^expand_test, {reflect_constant(test), std::meta::reflect_constant(ann)}));
@@ -68,12 +92,84 @@ public:
     full_name = define_static_array(meta_name);
   }
 
-  std::vector<TestCase> get_tests() const { return (this->*get_tests_impl)(); }
+  // expanded on first use and kept for the rest of the process,
+  // runtime parameter generators run at most once
+  std::span<TestCase const> get_tests() const { return (this->*get_tests_impl)(); }
 };
 
 using TestDef = Test (*)();
 
 struct Reporter;
+namespace _testing_impl {
+class Schedule;
+}
+
+struct ChangedLines {
+  std::string file;
+  std::size_t first = 0;
+  std::size_t last  = std::numeric_limits<std::size_t>::max();  // whole file by default
+};
+
+struct RunConfig {
+  std::size_t jobs = 1;  // workers, 0 selects one per hardware thread
+
+  // run cases in forked worker processes so crashes only fail the offending case
+  bool isolate             = false;
+  std::size_t memory_limit = 0;  // address space limit per worker in MiB, requires `isolate`
+  std::size_t cpu_limit    = 0;  // CPU time limit per case in seconds, requires `isolate`
+  std::size_t timeout      = 0;  // wall clock limit per case in seconds, requires `isolate`
+
+  // capture stdout of every case, ignored if cases run on several threads
+  // stderr is left alone by default so sanitizer reports of crashing cases stay visible
+  bool capture        = true;
+  bool capture_stderr = false;
+
+  // read performance counters around every test case, see PerfResult
+  bool perf_counters = false;
+
+  // only run the cases assigned to shard `shard_index` out of `shard_count`
+  std::size_t shard_index = 0;
+  std::size_t shard_count = 1;
+
+  // history database of previous runs, used to balance shards and order long cases first
+  std::string history;
+  std::size_t history_report = 0;  // print the N slowest cases and biggest regressions
+
+  // lines reached by every case, written by coverage runs
+  std::string impact_index;
+  // if not empty, only run cases that reached one of these lines according to `impact_index`
+  std::vector<ChangedLines> changes;
+
+  // which assertions are kept in results, all of them are counted either way
+  AssertionTracking assertion_tracking = AssertionTracking::all;
+  std::size_t assertion_limit          = 64;     // assertions kept with AssertionTracking::last
+  bool assertion_sites                 = false;  // count outcomes per ASSERT across the run
+
+  // measure rsl::benchmark tests, otherwise every benchmark body runs once like a test
+  bool benchmark                = false;
+  std::size_t benchmark_samples = 10;
+  double benchmark_min_time     = 10;  // minimum duration of a sample in milliseconds
+
+  // mutate inputs of rsl::fuzz tests, otherwise every target only replays the empty input
+  // and its corpus like a test
+  bool fuzz = false;
+
+  // budget of every rsl::fuzz test, whichever is exhausted first. 0 means unlimited
+  std::size_t fuzz_runs    = 10'000;
+  double fuzz_time         = 0;  // in seconds
+  std::size_t fuzz_max_len = 4096;
+  std::uint64_t fuzz_seed  = 0;  // 0 picks a random seed
+
+  // inputs reaching new coverage are kept in a subdirectory per fuzz target,
+  // failing inputs are additionally replayed as regular cases on every run
+  // crash replays are fixed once a test is expanded, see `Test::get_tests`
+  std::string fuzz_corpus;
+  bool fuzz_minimize = false;  // drop corpus inputs that do not add coverage
+
+  // forked fuzzers per target sharing their corpus, 0 starts one per core
+  std::size_t fuzz_jobs = 1;
+};
+
 struct TestNamespace {
   std::string_view name;
   std::vector<Test> tests;
@@ -116,13 +212,13 @@ struct TestNamespace {
   void insert(const Test& test, size_t i = 0);
 
   [[nodiscard]] std::size_t count() const;
-  bool run(Reporter* reporter);
+  bool run(Reporter* reporter, _testing_impl::Schedule& schedule);
 
   void filter(std::span<std::string const> parts);
 };
 
 struct TestRoot : TestNamespace {
-  bool run(Reporter* reporter);
+  bool run(Reporter* reporter, RunConfig const& config = {});
 };
 
 TestRoot get_tests();
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+
+namespace rsl::alloc {
+struct AllocationCounters {
+  std::size_t count = 0;  // allocations, reallocations included
+  std::size_t bytes = 0;  // allocated in total
+  std::size_t peak  = 0;  // highest live heap above the level at the start
+};
+}  // namespace rsl::alloc
+
+// starts counting heap allocations made by the calling thread
+extern "C" __attribute__((weak))
+void _rsl_test_allocations_start();
+
+// stops counting and reports what the calling thread allocated since the matching start
+extern "C" __attribute__((weak))
+void _rsl_test_allocations_stop(rsl::alloc::AllocationCounters* output);
+
+// pauses or resumes counting between start and stop, returns whether it was paused before
+extern "C" __attribute__((weak))
+bool _rsl_test_allocations_pause(bool paused);
+
+namespace rsl::alloc {
+//? only allocations of the test itself count towards its limit. The runner counts inside
+//? these sections and pauses them for its own bookkeeping, such as storing assertions
+class CountingSection {
+  bool was_paused = true;
+
+public:
+  explicit CountingSection(bool counting) {
+    if (_rsl_test_allocations_pause != nullptr) {
+      was_paused = _rsl_test_allocations_pause(!counting);
+    }
+  }
+
+  CountingSection(CountingSection const&)            = delete;
+  CountingSection& operator=(CountingSection const&) = delete;
+
+  ~CountingSection() {
+    if (_rsl_test_allocations_pause != nullptr) {
+      _rsl_test_allocations_pause(was_paused);
+    }
+  }
+};
+}  // namespace rsl::alloc
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+
+#include <malloc.h>
+
+#include "allocations.hpp"
+
+//? interposes on the C allocation functions, operator new and delete end up here as well
+//? only glibc exposes its allocator under another name. Elsewhere this library is empty and
+//? allocations are not tracked
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(std::size_t size) noexcept;
+void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+void* __libc_realloc(void* ptr, std::size_t size) noexcept;
+void* __libc_memalign(std::size_t alignment, std::size_t size) noexcept;
+void* __libc_valloc(std::size_t size) noexcept;
+void* __libc_pvalloc(std::size_t size) noexcept;
+void __libc_free(void* ptr) noexcept;
+}
+
+namespace {
+//? counted per thread so concurrently running tests do not see each other's allocations
+//? initial-exec TLS is set up without allocating, which matters inside malloc
+struct Counter {
+  bool active         = false;
+  bool started        = false;  // between start and stop, counting may be paused meanwhile
+  std::size_t count   = 0;
+  std::size_t bytes   = 0;
+  std::ptrdiff_t live = 0;  // negative if memory from before the start was released
+  std::ptrdiff_t peak = 0;
+};
+
+[[gnu::tls_model("initial-exec")]] constinit thread_local Counter counter{};
+
+void* allocated(void* ptr) {
+  if (ptr != nullptr && counter.active) {
+    auto size = malloc_usable_size(ptr);
+    ++counter.count;
+    counter.bytes += size;
+    counter.live += std::ptrdiff_t(size);
+    counter.peak = std::max(counter.peak, counter.live);
+  }
+  return ptr;
+}
+
+void released(void* ptr) {
+  if (ptr != nullptr && counter.active) {
+    counter.live -= std::ptrdiff_t(malloc_usable_size(ptr));
+  }
+}
+}  // namespace
+
+extern "C" {
+void* malloc(std::size_t size) noexcept {
+  return allocated(__libc_malloc(size));
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+  return allocated(__libc_calloc(count, size));
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept {
+  auto const old = ptr != nullptr && counter.active ? malloc_usable_size(ptr) : 0;
+  auto* result   = __libc_realloc(ptr, size);
+  if (result != nullptr || size == 0) {
+    // the old block is gone, on failure it is still owned by the caller
+    counter.live -= std::ptrdiff_t(old);
+  }
+  return allocated(result);
+}
+
+// glibc's own reallocarray would call its realloc directly
+void* reallocarray(void* ptr, std::size_t count, std::size_t size) noexcept {
+  std::size_t total = 0;
+  if (__builtin_mul_overflow(count, size, &total)) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  return realloc(ptr, total);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+  return allocated(__libc_memalign(alignment, size));
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+  return allocated(__libc_memalign(alignment, size));
+}
+
+void* valloc(std::size_t size) noexcept {
+  return allocated(__libc_valloc(size));
+}
+
+void* pvalloc(std::size_t size) noexcept {
+  return allocated(__libc_pvalloc(size));
+}
+
+int posix_memalign(void** output, std::size_t alignment, std::size_t size) noexcept {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  auto* ptr = __libc_memalign(alignment, size);
+  if (ptr == nullptr) {
+    return ENOMEM;
+  }
+  *output = allocated(ptr);
+  return 0;
+}
+
+void free(void* ptr) noexcept {
+  released(ptr);
+  __libc_free(ptr);
+}
+
+void _rsl_test_allocations_start() {
+  counter = {.active = true, .started = true};
+}
+
+void _rsl_test_allocations_stop(rsl::alloc::AllocationCounters* output) {
+  counter.active  = false;
+  counter.started = false;
+  *output         = {.count = counter.count,
+                     .bytes = counter.bytes,
+                     .peak  = std::size_t(std::max(counter.peak, std::ptrdiff_t{0}))};
+}
+
+bool _rsl_test_allocations_pause(bool paused) {
+  bool const was_paused = !counter.active;
+  counter.active        = counter.started && !paused;
+  return was_paused;
+}
+}
+#endif
@@ -0,0 +1,69 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "alloc/allocations.hpp"
+
+namespace rsl::testing::_testing_impl {
+namespace {
+double run_iterations(TestCase const& test_case, std::size_t iterations) {
+  auto counting = rsl::alloc::CountingSection(true);
+  auto t0       = std::chrono::steady_clock::now();
+  for (std::size_t idx = 0; idx < iterations; ++idx) {
+    test_case.fnc(test_case.args);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+}  // namespace
+
+BenchmarkSettings& benchmark_settings() {
+  static BenchmarkSettings settings{};
+  return settings;
+}
+
+BenchmarkResult measure(TestCase const& test_case, BenchmarkSettings const& settings) {
+  auto const target_ns = settings.min_sample_ms * 1e6;
+
+  // calibration doubles as warmup: grow the iteration count until one sample takes long enough
+  std::size_t iterations = 1;
+  while (true) {
+    auto elapsed = run_iterations(test_case, iterations);
+    if (elapsed >= target_ns) {
+      break;
+    }
+    // aim slightly above the target, but never grow by more than 10x at once
+    auto factor = elapsed <= 0 ? 10.0 : std::clamp(target_ns * 1.2 / elapsed, 2.0, 10.0);
+    iterations  = std::size_t(double(iterations) * factor);
+  }
+
+  std::vector<double> samples(std::max(settings.samples, std::size_t{1}));
+  for (auto& sample : samples) {
+    sample = run_iterations(test_case, iterations) / double(iterations);
+  }
+  std::ranges::sort(samples);
+
+  auto count = double(samples.size());
+  auto mean  = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+
+  auto sum_of_squares =
+      std::accumulate(samples.begin(), samples.end(), 0.0, [&](double acc, double sample) {
+        return acc + (sample - mean) * (sample - mean);
+      });
+  auto middle = samples.size() / 2;
+
+  return {
+      .iterations = iterations,
+      .samples    = samples.size(),
+      .min_ns     = samples.front(),
+      .median_ns  = samples.size() % 2 == 0 ? (samples[middle - 1] + samples[middle]) / 2
+                                            : samples[middle],
+      .mean_ns    = mean,
+      .stddev_ns  = samples.size() > 1 ? std::sqrt(sum_of_squares / (count - 1)) : 0,
+  };
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+#include <rsl/testing/result.hpp>
+#include <rsl/testing/test.hpp>
+
+namespace rsl::testing::_testing_impl {
+struct BenchmarkSettings {
+  bool enabled         = false;
+  std::size_t samples  = 10;
+  double min_sample_ms = 10;
+};
+
+BenchmarkSettings& benchmark_settings();
+
+// warm up, calibrate the iteration count and collect samples of `test_case`
+BenchmarkResult measure(TestCase const& test_case, BenchmarkSettings const& settings);
+}  // namespace rsl::testing::_testing_impl
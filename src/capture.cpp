@@ -1,5 +1,8 @@
 #include "capture.hpp"
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -11,75 +14,169 @@
 #else
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
 
 namespace rsl::testing {
+namespace {
+int open_capture_file(FILE*& owner) {
+#ifdef __linux__
+  int fd = memfd_create("rsltest-capture", MFD_CLOEXEC);
+  if (fd >= 0) {
+    return fd;
+  }
+#endif
+  owner = std::tmpfile();
+  return owner == nullptr ? -1 : fileno(owner);
+}
+
+bool read_all(int fd, char* data, std::size_t size) {
+  while (size != 0) {
+    auto received = read(fd, data, size);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    data += received;
+    size -= std::size_t(received);
+  }
+  return true;
+}
+
+// at most one capture per standard stream, indexed by its file descriptor
+std::array<std::atomic<Capture const*>, 3> active_captures{};
+
+#ifndef _WIN32
+constexpr auto fatal_signals = std::array{SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+std::array<struct sigaction, fatal_signals.size()> previous_actions{};
+
+void write_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    auto written = write(fd, data.data(), data.size());
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return;
+    }
+    data.remove_prefix(std::size_t(written));
+  }
+}
+#endif
+}  // namespace
+
+CaptureSettings& capture_output() {
+  static CaptureSettings settings{};
+  return settings;
+}
 
 RedirectedOutput::RedirectedOutput(FILE* redirected_stream, int original_fd)
     : redirected(redirected_stream)
     , underlying_fd(original_fd) {
-  underlying    = fdopen(original_fd, "w");
   redirected_fd = fileno(redirected_stream);
 }
 
-Capture::Capture(FILE* stream, std::string& target, bool echo )
-    : target(&target)
-    , echo(echo) {
-  fflush(stream);
-  out = {stream, dup(fileno(stream))};
-#ifdef _WIN32
-  _pipe(pipe_fds_, 8192, _O_BINARY);
-#else
-  pipe(pipe_fds_);
-  fcntl(pipe_fds_[0], F_SETFL, O_NONBLOCK);
+Capture::Capture(FILE* stream, std::string& target)
+    : target(&target) {
+#ifndef _WIN32
+  static bool const installed = [] {
+    struct sigaction action{};
+    action.sa_handler = on_fatal_signal;
+    sigemptyset(&action.sa_mask);
+    for (std::size_t idx = 0; idx < fatal_signals.size(); ++idx) {
+      sigaction(fatal_signals[idx], &action, &previous_actions[idx]);
+    }
+    return true;
+  }();
+  (void)installed;
 #endif
-  dup2(pipe_fds_[1], out.redirected_fd);
+
+  fflush(stream);
+  out     = {stream, dup(fileno(stream))};
+  file_fd = open_capture_file(file);
+  if (file_fd >= 0) {
+    dup2(file_fd, out.redirected_fd);
+    if (std::size_t(out.redirected_fd) < active_captures.size()) {
+      active_captures[std::size_t(out.redirected_fd)] = this;
+    }
+  }
 }
 
 Capture::~Capture() {
+  if (std::size_t(out.redirected_fd) < active_captures.size()) {
+    active_captures[std::size_t(out.redirected_fd)] = nullptr;
+  }
   fflush(out.redirected);
   dup2(out.underlying_fd, out.redirected_fd);
-  close(pipe_fds_[1]);
 
-  drain();  // Final flush
-
-  close(pipe_fds_[0]);
+  if (file_fd >= 0) {
+    collect();
+    if (file != nullptr) {
+      fclose(file);
+    } else {
+      close(file_fd);
+    }
+  }
   close(out.underlying_fd);
 }
 
-static int read_pipe(int fd, char* buffer, size_t size) {
-#ifdef _WIN32
-  HANDLE h        = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
-  DWORD available = 0;
-  if (PeekNamedPipe(h, nullptr, 0, nullptr, &available, nullptr) && available > 0)
-    return _read(fd, buffer, static_cast<unsigned>(size));
-  return 0;
-#else
-  ssize_t n = read(fd, buffer, size);
-  if (n > 0)
-    return static_cast<int>(n);
-  if (errno == EAGAIN || errno == EWOULDBLOCK)
-    return 0;
-  return -1;
+void Capture::collect() {
+  auto size = lseek(file_fd, 0, SEEK_END);
+  if (size <= 0) {
+    return;
+  }
+
+  auto const offset = target->size();
+#ifndef _WIN32
+  auto* data = mmap(nullptr, std::size_t(size), PROT_READ, MAP_PRIVATE, file_fd, 0);
+  if (data != MAP_FAILED) {
+    target->append(static_cast<char const*>(data), std::size_t(size));
+    munmap(data, std::size_t(size));
+  } else
 #endif
+  {
+    lseek(file_fd, 0, SEEK_SET);
+    target->resize(offset + std::size_t(size));
+    if (!read_all(file_fd, target->data() + offset, std::size_t(size))) {
+      target->resize(offset);
+    }
+  }
 }
 
-void Capture::drain() {
-  fflush(out.redirected);
-  char buffer[256];
+#ifndef _WIN32
+void Capture::release() const {
+  dup2(out.underlying_fd, out.redirected_fd);
+  char chunk[4096];
+  off_t offset = 0;
   while (true) {
-    int n = read_pipe(pipe_fds_[0], buffer, sizeof(buffer));
-    if (n > 0) {
-      *target += std::string_view(buffer, n);
-      if (echo) {
-        write(out.underlying_fd, buffer, n);
-      }
-    } else {
+    auto received = pread(file_fd, chunk, sizeof(chunk), offset);
+    if (received <= 0) {
       break;
     }
+    write_all(out.redirected_fd, std::string_view(chunk, std::size_t(received)));
+    offset += received;
   }
 }
 
-}  // namespace rsl::testing
\ No newline at end of file
+void Capture::on_fatal_signal(int signal) {
+  for (auto& capture : active_captures) {
+    if (auto const* active = capture.exchange(nullptr); active != nullptr) {
+      active->release();
+    }
+  }
+
+  // hand the signal to whoever was installed before, it is delivered once this returns
+  for (std::size_t idx = 0; idx < fatal_signals.size(); ++idx) {
+    if (fatal_signals[idx] == signal) {
+      sigaction(signal, &previous_actions[idx], nullptr);
+    }
+  }
+  raise(signal);
+}
+#endif
+}  // namespace rsl::testing
@@ -6,7 +6,6 @@ namespace rsl::testing {
 
 struct RedirectedOutput {
   FILE* redirected = nullptr;
-  FILE* underlying = nullptr;
 
   int redirected_fd = -1;
   int underlying_fd = -1;
@@ -16,16 +15,34 @@ struct RedirectedOutput {
   RedirectedOutput(FILE* redirected_stream, int original_fd);
 };
 
+//? redirects a stream into an anonymous in-memory file (a temporary file where memfd is not
+//? available). Nothing is read while the test runs, so writes never block and there is no
+//? size limit. The file is mapped and appended to `target` once the capture ends
+//? if the process dies from a fatal signal meanwhile, everything captured so far is written
+//? to the original stream and the stream is restored, so crash reports stay visible
 class Capture {
-  int pipe_fds_[2]{};
+  int file_fd = -1;
+  FILE* file  = nullptr;  // owns `file_fd` if it had to be created with tmpfile
   std::string* target;
-  bool echo;
+
+  void collect();
+  void release() const;  // async-signal-safe
+  static void on_fatal_signal(int signal);
 
 public:
   RedirectedOutput out;
 
-  Capture(FILE* stream, std::string& target, bool echo = false);
+  Capture(FILE* stream, std::string& target);
+  Capture(Capture const&)            = delete;
+  Capture& operator=(Capture const&) = delete;
   ~Capture();
-  void drain();
 };
-}  // namespace rsl::testing
\ No newline at end of file
+
+// which streams of test cases are captured
+// redirection is process wide, so this is only enabled if cases never run concurrently
+struct CaptureSettings {
+  bool out = false;
+  bool err = false;
+};
+CaptureSettings& capture_output();
+}  // namespace rsl::testing
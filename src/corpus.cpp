@@ -0,0 +1,117 @@
+#include "corpus.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+#include "fuzz.hpp"
+#include "mapped_file.hpp"
+#include "schedule.hpp"
+
+namespace rsl::testing::_testing_impl {
+namespace {
+std::string content_name(std::span<std::uint8_t const> input) {
+  // 64 bit FNV-1a
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (auto byte : input) {
+    hash ^= byte;
+    hash *= 1099511628211ULL;
+  }
+  return std::format("{:016x}", hash);
+}
+
+std::string directory_name(std::string_view case_id) {
+  // ns::target(args) -> ns.target_args
+  std::string name;
+  for (std::size_t idx = 0; idx < case_id.size(); ++idx) {
+    auto chr = case_id[idx];
+    if (case_id.substr(idx).starts_with("::")) {
+      name += '.';
+      ++idx;
+    } else if (std::isalnum(static_cast<unsigned char>(chr)) != 0 || chr == '_' || chr == '-') {
+      name += chr;
+    } else if (!name.empty() && name.back() != '_') {
+      name += '_';
+    }
+  }
+  while (name.ends_with('_')) {
+    name.pop_back();
+  }
+  return name;
+}
+
+std::vector<CorpusInput> read_directory(std::filesystem::path const& path) {
+  std::vector<CorpusInput> inputs;
+  std::error_code ec;
+  for (auto const& entry : std::filesystem::directory_iterator(path, ec)) {
+    if (!entry.is_regular_file() || entry.path().filename().string().starts_with('.')) {
+      continue;
+    }
+    auto file    = MappedFile(entry.path().string());
+    auto content = file.view();
+    inputs.push_back({entry.path().filename().string(), {content.begin(), content.end()}});
+  }
+  std::ranges::sort(inputs, [](CorpusInput const& lhs, CorpusInput const& rhs) {
+    return lhs.data.size() != rhs.data.size() ? lhs.data.size() < rhs.data.size()
+                                              : lhs.id < rhs.id;
+  });
+  return inputs;
+}
+
+void write_file(std::filesystem::path const& path, std::span<std::uint8_t const> input) {
+  if (std::filesystem::exists(path)) {
+    return;
+  }
+  // write to a temporary first so readers never see partial inputs
+  // the name must be unique, parallel fuzzers might find the same input at the same time
+  auto temporary = path;
+  temporary.replace_filename(
+      std::format(".{}.{:08x}.tmp", path.filename().string(), std::random_device{}()));
+  {
+    auto out = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<char const*>(input.data()), std::streamsize(input.size()));
+  }
+  std::filesystem::rename(temporary, path);
+}
+}  // namespace
+
+CorpusDirectory::CorpusDirectory(std::string_view base, std::string_view case_id)
+    : root(std::filesystem::path(base) / directory_name(case_id)) {}
+
+std::vector<CorpusInput> CorpusDirectory::load() const {
+  return read_directory(root);
+}
+
+std::vector<CorpusInput> CorpusDirectory::crashes() const {
+  return read_directory(root / "crashes");
+}
+
+void CorpusDirectory::save(std::span<std::uint8_t const> input) const {
+  std::filesystem::create_directories(root);
+  write_file(root / content_name(input), input);
+}
+
+void CorpusDirectory::remove(CorpusInput const& input) const {
+  std::error_code ec;
+  std::filesystem::remove(root / input.id, ec);
+}
+
+std::string CorpusDirectory::save_crash(std::span<std::uint8_t const> input) const {
+  auto directory = root / "crashes";
+  std::filesystem::create_directories(directory);
+  auto path = directory / ("crash-" + content_name(input));
+  write_file(path, input);
+  return path.string();
+}
+
+std::vector<CorpusInput> load_crashes(Test const* test, std::string_view case_name) {
+  auto const& settings = fuzz_settings();
+  if (settings.corpus.empty()) {
+    return {};
+  }
+  return CorpusDirectory(settings.corpus, case_id(*test, case_name)).crashes();
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rsl/testing/test.hpp>
+
+namespace rsl::testing::_testing_impl {
+// on-disk corpus of a single fuzz target
+// every input is stored in its own file named after a hash of its content,
+// inputs that made the target fail are kept in the `crashes` subdirectory
+class CorpusDirectory {
+  std::filesystem::path root;
+
+public:
+  CorpusDirectory(std::string_view base, std::string_view case_id);
+
+  // all stored inputs, smallest first
+  [[nodiscard]] std::vector<CorpusInput> load() const;
+  [[nodiscard]] std::vector<CorpusInput> crashes() const;
+
+  void save(std::span<std::uint8_t const> input) const;
+  void remove(CorpusInput const& input) const;
+  // returns the path of the written file
+  [[nodiscard]] std::string save_crash(std::span<std::uint8_t const> input) const;
+};
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,190 @@
+#include "counters.hpp"
+
+#include <array>
+#include <cstdint>
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <sys/resource.h>
+#  include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#endif
+
+namespace rsl::testing::_testing_impl {
+namespace {
+#ifdef _WIN32
+double to_ms(FILETIME const& time) {
+  // 100 nanosecond intervals
+  auto const ticks = std::uint64_t(time.dwHighDateTime) << 32U | time.dwLowDateTime;
+  return double(ticks) / 1e4;
+}
+
+// only CPU time is available for a single thread, the other counters stay 0
+PerfResult os_counters() {
+  FILETIME created{};
+  FILETIME exited{};
+  FILETIME kernel{};
+  FILETIME user{};
+  if (GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user) == 0) {
+    return {};
+  }
+  return {.user_ms = to_ms(user), .system_ms = to_ms(kernel)};
+}
+#else
+double to_ms(timeval const& time) {
+  return double(time.tv_sec) * 1e3 + double(time.tv_usec) / 1e3;
+}
+
+PerfResult os_counters() {
+  rusage usage{};
+#if defined(RUSAGE_THREAD)
+  getrusage(RUSAGE_THREAD, &usage);
+#else
+  getrusage(RUSAGE_SELF, &usage);
+#endif
+  return {.user_ms              = to_ms(usage.ru_utime),
+          .system_ms            = to_ms(usage.ru_stime),
+          .minor_faults         = std::uint64_t(usage.ru_minflt),
+          .major_faults         = std::uint64_t(usage.ru_majflt),
+          .voluntary_switches   = std::uint64_t(usage.ru_nvcsw),
+          .involuntary_switches = std::uint64_t(usage.ru_nivcsw)};
+}
+#endif
+
+#if defined(__linux__)
+//? one group per thread, opened on first use and reset for every test case
+//? members the PMU does not support are left out, the group works without them
+class EventGroup {
+  static constexpr std::array<std::uint64_t, 4> events = {PERF_COUNT_HW_CPU_CYCLES,
+                                                          PERF_COUNT_HW_INSTRUCTIONS,
+                                                          PERF_COUNT_HW_CACHE_MISSES,
+                                                          PERF_COUNT_HW_BRANCH_MISSES};
+  static constexpr std::uint64_t read_format =
+      PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  std::array<int, events.size()> fds{-1, -1, -1, -1};
+  pid_t owner = -1;  // counters opened before a fork keep counting the parent
+
+  static int open_event(std::uint64_t config, int leader) {
+    perf_event_attr attr{};
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = leader == -1 ? 1 : 0;  // members follow their leader
+    attr.exclude_kernel = 1;                     // permitted with perf_event_paranoid <= 2
+    attr.exclude_hv     = 1;
+    attr.read_format    = read_format;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, PERF_FLAG_FD_CLOEXEC));
+  }
+
+  void close_all() {
+    for (auto& fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      fd = -1;
+    }
+  }
+
+  void open_all() {
+    close_all();
+    owner  = getpid();
+    fds[0] = open_event(events[0], -1);
+    if (fds[0] < 0) {
+      return;
+    }
+    for (std::size_t idx = 1; idx < events.size(); ++idx) {
+      fds[idx] = open_event(events[idx], fds[0]);
+    }
+  }
+
+public:
+  EventGroup()                             = default;
+  EventGroup(EventGroup const&)            = delete;
+  EventGroup& operator=(EventGroup const&) = delete;
+  ~EventGroup() { close_all(); }
+
+  bool start() {
+    if (owner != getpid()) {
+      open_all();
+    }
+    if (fds[0] < 0) {
+      return false;
+    }
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+  }
+
+  void stop(PerfResult& result) {
+    ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    struct {
+      std::uint64_t count;
+      std::uint64_t time_enabled;
+      std::uint64_t time_running;
+      std::array<std::uint64_t, events.size()> values;
+    } data{};
+    if (read(fds[0], &data, sizeof(data)) <= 0 || data.time_running == 0) {
+      return;
+    }
+
+    // extrapolate if the group had to share the PMU with other users
+    auto scale = double(data.time_enabled) / double(data.time_running);
+    std::array<std::optional<std::uint64_t>*, events.size()> targets = {&result.cycles,
+                                                                        &result.instructions,
+                                                                        &result.cache_misses,
+                                                                        &result.branch_misses};
+    std::size_t slot = 0;
+    for (std::size_t idx = 0; idx < events.size() && slot < data.count; ++idx) {
+      if (fds[idx] >= 0) {
+        *targets[idx] = std::uint64_t(double(data.values[slot++]) * scale);
+      }
+    }
+  }
+};
+
+EventGroup& event_group() {
+  thread_local EventGroup group;
+  return group;
+}
+#endif
+}  // namespace
+
+bool& perf_counters() {
+  static bool enabled = false;
+  return enabled;
+}
+
+CounterScope::CounterScope(std::optional<PerfResult>& target)
+    : target(&target)
+    , start(os_counters()) {
+#if defined(__linux__)
+  hardware = event_group().start();
+#endif
+}
+
+CounterScope::~CounterScope() {
+  auto& delta = target->emplace();
+#if defined(__linux__)
+  if (hardware) {
+    event_group().stop(delta);
+  }
+#endif
+  auto end = os_counters();
+  delta.user_ms              = end.user_ms - start.user_ms;
+  delta.system_ms            = end.system_ms - start.system_ms;
+  delta.minor_faults         = end.minor_faults - start.minor_faults;
+  delta.major_faults         = end.major_faults - start.major_faults;
+  delta.voluntary_switches   = end.voluntary_switches - start.voluntary_switches;
+  delta.involuntary_switches = end.involuntary_switches - start.involuntary_switches;
+}
+}  // namespace rsl::testing::_testing_impl
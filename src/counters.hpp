@@ -0,0 +1,24 @@
+#pragma once
+#include <optional>
+
+#include <rsl/testing/result.hpp>
+
+namespace rsl::testing::_testing_impl {
+// whether test cases run with performance counters
+bool& perf_counters();
+
+//? measures the calling thread from construction to destruction
+//? hardware counters come from perf_event_open where permitted, CPU time, page faults and
+//? context switches from getrusage are always available. Windows only reports CPU time
+class CounterScope {
+  std::optional<PerfResult>* target;
+  PerfResult start;
+  bool hardware = false;
+
+public:
+  explicit CounterScope(std::optional<PerfResult>& target);
+  CounterScope(CounterScope const&)            = delete;
+  CounterScope& operator=(CounterScope const&) = delete;
+  ~CounterScope();
+};
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,273 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+#ifndef _WIN32
+#  include <csignal>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#include "hooks.hpp"
+
+//? backend for -fsanitize-coverage=inline-8bit-counters,pc-table
+//? instrumented code increments a byte per edge without calling into the runtime
+//? to keep per-test cost proportional to the code a test reaches, counter pages are
+//? write-protected between tests. The first write to a page faults once, marks the page
+//? dirty and unprotects it. Only dirty pages are scanned and reset after the test.
+//? fuzz targets reset the counters before every input, reached pages stay writable for the
+//? whole target instead of faulting again on every input
+
+namespace rsl::coverage {
+namespace {
+struct CounterRegion {
+  std::uint8_t* begin     = nullptr;
+  std::uint8_t* end       = nullptr;
+  PCTableEntry const* pcs = nullptr;
+
+  // fully contained pages are tracked, partial pages at either edge are always scanned
+  std::uint8_t* tracked_begin = nullptr;
+  std::uint8_t* tracked_end   = nullptr;
+  std::vector<std::uint8_t> dirty;  // one flag per tracked page
+};
+
+std::vector<CounterRegion>& regions() {
+  static std::vector<CounterRegion> data;
+  return data;
+}
+
+std::size_t page_size = 4096;
+bool tracking_enabled = false;
+bool tracking_failed  = false;
+
+// calls `fnc(offset)` for every non-zero byte in [data, data + size)
+template <typename F>
+void for_each_nonzero(std::uint8_t const* data, std::size_t size, F&& fnc) {
+  std::size_t idx = 0;
+#if defined(__AVX2__)
+  auto const zero = _mm256_setzero_si256();
+  for (; idx + 32 <= size; idx += 32) {
+    auto chunk   = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + idx));
+    auto nonzero = ~std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero)));
+    for (; nonzero != 0; nonzero &= nonzero - 1) {
+      fnc(idx + std::size_t(std::countr_zero(nonzero)));
+    }
+  }
+#elif defined(__SSE2__)
+  auto const zero = _mm_setzero_si128();
+  for (; idx + 16 <= size; idx += 16) {
+    auto chunk   = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + idx));
+    auto nonzero = ~std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero))) & 0xFFFFU;
+    for (; nonzero != 0; nonzero &= nonzero - 1) {
+      fnc(idx + std::size_t(std::countr_zero(nonzero)));
+    }
+  }
+#endif
+  for (; idx + 8 <= size; idx += 8) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, data + idx, sizeof(word));
+    if (word == 0) {
+      continue;
+    }
+    for (std::size_t offset = 0; offset < 8; ++offset) {
+      if (data[idx + offset] != 0) {
+        fnc(idx + offset);
+      }
+    }
+  }
+  for (; idx < size; ++idx) {
+    if (data[idx] != 0) {
+      fnc(idx);
+    }
+  }
+}
+
+// calls `fnc(begin, end)` for every part of `region` that might have been written to
+template <typename F>
+void for_each_dirty_range(CounterRegion& region, F&& fnc) {
+  if (!tracking_enabled || region.tracked_begin == region.tracked_end) {
+    fnc(region.begin, region.end);
+    return;
+  }
+
+  fnc(region.begin, region.tracked_begin);
+  for (std::size_t page = 0; page < region.dirty.size(); ++page) {
+    if (region.dirty[page] != 0) {
+      auto* start = region.tracked_begin + page * page_size;
+      fnc(start, start + page_size);
+    }
+  }
+  fnc(region.tracked_end, region.end);
+}
+
+#ifndef _WIN32
+struct sigaction previous_handler{};
+
+void on_fault(int signal, siginfo_t* info, void* context) {
+  auto* address = static_cast<std::uint8_t*>(info->si_addr);
+  for (auto& region : regions()) {
+    if (address < region.tracked_begin || address >= region.tracked_end) {
+      continue;
+    }
+    auto page          = std::size_t(address - region.tracked_begin) / page_size;
+    region.dirty[page] = 1;
+    mprotect(region.tracked_begin + page * page_size, page_size, PROT_READ | PROT_WRITE);
+    return;
+  }
+
+  // not ours, hand it to whoever was installed before
+  if ((previous_handler.sa_flags & SA_SIGINFO) != 0 && previous_handler.sa_sigaction != nullptr) {
+    previous_handler.sa_sigaction(signal, info, context);
+    return;
+  }
+  if (previous_handler.sa_handler != SIG_DFL && previous_handler.sa_handler != SIG_IGN) {
+    previous_handler.sa_handler(signal);
+    return;
+  }
+  // restore the default action, the faulting instruction is retried and terminates
+  std::signal(signal, SIG_DFL);
+}
+
+bool protect(std::uint8_t* begin, std::uint8_t* end) {
+  return begin == end || mprotect(begin, std::size_t(end - begin), PROT_READ) == 0;
+}
+
+void enable_tracking() {
+  page_size = std::size_t(sysconf(_SC_PAGESIZE));
+  for (auto& region : regions()) {
+    auto first = (std::uintptr_t(region.begin) + page_size - 1) & ~(page_size - 1);
+    auto last  = std::uintptr_t(region.end) & ~(page_size - 1);
+    if (first >= last) {
+      region.tracked_begin = region.tracked_end = region.begin;
+      continue;
+    }
+    region.tracked_begin = reinterpret_cast<std::uint8_t*>(first);
+    region.tracked_end   = reinterpret_cast<std::uint8_t*>(last);
+    region.dirty.assign((last - first) / page_size, 0);
+  }
+
+  struct sigaction action{};
+  action.sa_sigaction = on_fault;
+  action.sa_flags     = SA_SIGINFO | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGSEGV, &action, &previous_handler) != 0) {
+    tracking_failed = true;
+    return;
+  }
+
+  for (auto& region : regions()) {
+    std::memset(region.begin, 0, std::size_t(region.end - region.begin));
+    if (!protect(region.tracked_begin, region.tracked_end)) {
+      tracking_failed = true;
+    }
+  }
+  tracking_enabled = !tracking_failed;
+  if (tracking_failed) {
+    // fall back to full scans, make everything writable again
+    for (auto& region : regions()) {
+      mprotect(region.tracked_begin,
+               std::size_t(region.tracked_end - region.tracked_begin),
+               PROT_READ | PROT_WRITE);
+    }
+    sigaction(SIGSEGV, &previous_handler, nullptr);
+  }
+}
+#else
+void enable_tracking() {
+  tracking_failed = true;
+}
+#endif
+}  // namespace
+
+bool attach_pc_table(PCTableEntry const* pcs, std::size_t count) {
+  auto& known = regions();
+  if (known.empty() || known.back().pcs != nullptr ||
+      std::size_t(known.back().end - known.back().begin) != count) {
+    return false;
+  }
+  known.back().pcs = pcs;
+  return true;
+}
+
+void reset_inline_counters(bool reprotect) {
+  if (regions().empty()) {
+    return;
+  }
+  if (!tracking_enabled && !tracking_failed) {
+    enable_tracking();
+    return;
+  }
+
+  for (auto& region : regions()) {
+    for_each_dirty_range(region, [](std::uint8_t* begin, std::uint8_t* end) {
+      std::memset(begin, 0, std::size_t(end - begin));
+    });
+#ifndef _WIN32
+    if (!tracking_enabled || !reprotect) {
+      continue;
+    }
+    for (std::size_t page = 0; page < region.dirty.size(); ++page) {
+      if (region.dirty[page] != 0) {
+        region.dirty[page] = 0;
+        auto* start        = region.tracked_begin + page * page_size;
+        protect(start, start + page_size);
+      }
+    }
+#endif
+  }
+}
+
+void collect_inline_counters(std::unordered_map<std::uintptr_t, std::uint64_t>& reached) {
+  for (auto& region : regions()) {
+    if (region.pcs == nullptr) {
+      continue;
+    }
+    for_each_dirty_range(region, [&](std::uint8_t* begin, std::uint8_t* end) {
+      auto base = std::size_t(begin - region.begin);
+      for_each_nonzero(begin, std::size_t(end - begin), [&](std::size_t offset) {
+        // 8-bit counters wrap, hit counts are only meaningful as "reached"
+        reached[region.pcs[base + offset].pc] += begin[offset];
+      });
+    });
+  }
+}
+
+std::size_t collect_inline_edges(std::vector<EdgeHits>& edges) {
+  std::size_t base = 0;
+  for (auto& region : regions()) {
+    for_each_dirty_range(region, [&](std::uint8_t* begin, std::uint8_t* end) {
+      auto first = base + std::size_t(begin - region.begin);
+      for_each_nonzero(begin, std::size_t(end - begin), [&](std::size_t offset) {
+        edges.push_back({first + offset, begin[offset]});
+      });
+    });
+    base += std::size_t(region.end - region.begin);
+  }
+  return base;
+}
+
+void collect_inline_pcs(std::vector<std::uintptr_t>& pcs) {
+  for (auto const& region : regions()) {
+    if (region.pcs == nullptr) {
+      continue;
+    }
+    for (std::size_t idx = 0; idx < std::size_t(region.end - region.begin); ++idx) {
+      pcs.push_back(region.pcs[idx].pc);
+    }
+  }
+}
+}  // namespace rsl::coverage
+
+extern "C" void __sanitizer_cov_8bit_counters_init(std::uint8_t* start, std::uint8_t* stop) {
+  if (start == stop) {
+    return;
+  }
+  rsl::coverage::regions().push_back({.begin = start, .end = stop});
+}
@@ -15,3 +15,15 @@ void _rsl_test_run_with_coverage(
     void const* test, 
     rsl::coverage::CoverageReport** output,
     std::size_t* output_size);
+
+// every instrumented pc, including those no test has reached yet
+extern "C" __attribute__((weak))
+void _rsl_test_instrumented_pcs(std::uintptr_t** output, std::size_t* output_size);
+
+// runs `fnc(input)` and returns the number of coverage features it reached for the first time
+// since the last call to _rsl_test_reset_feedback
+extern "C" __attribute__((weak))
+std::size_t _rsl_test_run_with_feedback(void (*fnc)(void const*), void const* input);
+
+extern "C" __attribute__((weak))
+void _rsl_test_reset_feedback();
@@ -40,10 +40,16 @@ void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop) {
 void __sanitizer_cov_pcs_init(std::uintptr_t const* pcs_beg, std::uintptr_t const* pcs_end) {
   using rsl::coverage::guard_count;
   using rsl::coverage::pc_table;
+  auto const* table = reinterpret_cast<rsl::coverage::PCTableEntry const*>(pcs_beg);
+  if (rsl::coverage::attach_pc_table(table, (pcs_end - pcs_beg) / 2)) {
+    // module was built with inline-8bit-counters
+    return;
+  }
+
   guard_count = (pcs_end - pcs_beg) / 2;
   assert((pcs_end - pcs_beg) / 2 == guard_count);
 
-  pc_table = reinterpret_cast<rsl::coverage::PCTableEntry const*>(pcs_beg);
+  pc_table = table;
 }
 
 void __sanitizer_cov_trace_pc_guard(uint32_t* guard) {
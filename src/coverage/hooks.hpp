@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <cstddef>
+#include <unordered_map>
 #include <vector>
 
 namespace rsl::coverage {
@@ -17,6 +18,21 @@ extern std::uint64_t* counters;
 extern PCTableEntry const* pc_table;
 extern std::size_t guard_count;
 std::vector<std::uintptr_t>& pc_tracker();
+
+//? inline-8bit-counters backend, see counters.cpp
+// associates a pc table with the most recently registered counter region
+bool attach_pc_table(PCTableEntry const* pcs, std::size_t count);
+// zeroes the counters, pages reached since the last reprotection stay writable unless `reprotect`
+void reset_inline_counters(bool reprotect);
+void collect_inline_counters(std::unordered_map<std::uintptr_t, std::uint64_t>& reached);
+void collect_inline_pcs(std::vector<std::uintptr_t>& pcs);
+
+struct EdgeHits {
+  std::size_t edge;  // numbered consecutively across all counter regions
+  std::uint64_t hits;
+};
+// appends every reached edge, returns the total number of inline edges
+std::size_t collect_inline_edges(std::vector<EdgeHits>& edges);
 }  // namespace rsl::coverage
 
 extern "C" {
@@ -48,7 +64,7 @@ void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* end);
 void __sanitizer_cov_trace_pc_guard(uint32_t* guard);
 
 //? -fsanitize-coverage=inline-8bit-counters
-// void __sanitizer_cov_8bit_counters_init(uint8_t* start, uint8_t* end);
+void __sanitizer_cov_8bit_counters_init(uint8_t* start, uint8_t* end);
 
 //? -fsanitize-coverage=inline-bool-flag
 // void __sanitizer_cov_bool_flag_init(bool* start, bool* end);
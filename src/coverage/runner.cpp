@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <print>
 
@@ -5,7 +7,8 @@
 #include "coverage.hpp"
 namespace rsl::coverage {
 namespace {
-void reset_counters() {
+void reset_counters(bool reprotect) {
+  reset_inline_counters(reprotect);
   if (guard_count == 0 || counters == nullptr) {
     return;
   }
@@ -17,7 +20,8 @@ void reset_counters() {
 
 auto filter_traces() {
   std::unordered_map<std::uintptr_t, std::uint64_t> reached;
-  for (std::size_t idx = 0; idx < guard_count; ++idx) {
+  collect_inline_counters(reached);
+  for (std::size_t idx = 0; counters != nullptr && idx < guard_count; ++idx) {
     if (counters[idx] != 0) {
       reached[pc_table[idx].pc] = counters[idx];
     }
@@ -29,6 +33,56 @@ auto filter_traces() {
   return reached;
 }
 
+//? a feature is an edge together with the class of its hit count, the same as in libFuzzer
+//? reaching an edge more often than before (by an order of magnitude) counts as progress
+std::uint8_t hit_class(std::uint64_t hits) {
+  if (hits >= 128) {
+    return 1U << 7U;
+  }
+  if (hits >= 32) {
+    return 1U << 6U;
+  }
+  if (hits >= 16) {
+    return 1U << 5U;
+  }
+  if (hits >= 8) {
+    return 1U << 4U;
+  }
+  if (hits >= 4) {
+    return 1U << 3U;
+  }
+  return std::uint8_t(1U << (hits - 1));
+}
+
+std::vector<std::uint8_t>& seen_features() {
+  // one bit per hit class for every edge
+  static std::vector<std::uint8_t> data;
+  return data;
+}
+
+std::size_t count_new_features() {
+  static std::vector<EdgeHits> edges;
+  edges.clear();
+  auto guard_base = collect_inline_edges(edges);
+  for (std::size_t idx = 0; counters != nullptr && idx < guard_count; ++idx) {
+    if (counters[idx] != 0) {
+      edges.push_back({guard_base + idx, counters[idx]});
+    }
+  }
+
+  auto& seen = seen_features();
+  seen.resize(std::max(seen.size(), guard_base + guard_count));
+
+  std::size_t found = 0;
+  for (auto const& [edge, hits] : edges) {
+    auto feature = hit_class(hits);
+    if ((seen[edge] & feature) == 0) {
+      seen[edge] |= feature;
+      ++found;
+    }
+  }
+  return found;
+}
 }  // namespace
 }  // namespace rsl::coverage
 
@@ -59,7 +113,7 @@ extern "C" __attribute__((no_sanitize("coverage"))) void _rsl_test_run_with_cove
     *output_size = reached.size();
   };
 
-  reset_counters();
+  reset_counters(true);
   __sancov_should_track = 1;
   try {
     fnc(test);
@@ -68,4 +122,41 @@ extern "C" __attribute__((no_sanitize("coverage"))) void _rsl_test_run_with_cove
     throw;
   }
   finalize();
-}
\ No newline at end of file
+}
+
+extern "C" void _rsl_test_instrumented_pcs(std::uintptr_t** output, std::size_t* output_size) {
+  using namespace rsl::coverage;
+  std::vector<std::uintptr_t> pcs;
+  collect_inline_pcs(pcs);
+  for (std::size_t idx = 0; pc_table != nullptr && idx < guard_count; ++idx) {
+    pcs.push_back(pc_table[idx].pc);
+  }
+
+  *output = (std::uintptr_t*)malloc(sizeof(std::uintptr_t) * pcs.size());
+  std::ranges::copy(pcs, *output);
+  *output_size = pcs.size();
+}
+
+extern "C" __attribute__((no_sanitize("coverage"))) std::size_t _rsl_test_run_with_feedback(
+    void (*fnc)(void const*),
+    void const* input) {
+  //! not thread safe either, fuzz tests are always run serially
+  using namespace rsl::coverage;
+
+  // pages stay writable across inputs, _rsl_test_reset_feedback protects them again
+  reset_counters(false);
+  __sancov_should_track = 1;
+  try {
+    fnc(input);
+  } catch (...) {
+    __sancov_should_track = 0;
+    throw;
+  }
+  __sancov_should_track = 0;
+  return count_new_features();
+}
+
+extern "C" void _rsl_test_reset_feedback() {
+  rsl::coverage::reset_counters(true);
+  rsl::coverage::seen_features().clear();
+}
@@ -0,0 +1,49 @@
+#include "coverage_table.hpp"
+
+#include <algorithm>
+
+namespace rsl::testing::_testing_impl {
+void CoverageTable::FileData::add(std::size_t line, std::uint64_t count) {
+  if (line >= hits.size()) {
+    hits.resize(std::max(line + 1, hits.size() * 2));
+    known.resize((hits.size() + 63) / 64);
+  }
+  hits[line] += count;
+  known[line / 64] |= std::uint64_t{1} << (line % 64);
+}
+
+bool CoverageTable::FileData::is_known(std::size_t line) const {
+  return (known[line / 64] >> (line % 64) & 1U) != 0;
+}
+
+void CoverageTable::add(std::span<FileCoverage const> coverage) {
+  for (auto const& file : coverage) {
+    auto it = files.find(file.filename);
+    if (it == files.end()) {
+      it = files.emplace(file.filename, FileData{}).first;
+    }
+    for (auto const& [line, count] : file.coverage) {
+      it->second.add(line, count);
+    }
+  }
+}
+
+std::vector<FileCoverage> CoverageTable::lines() const {
+  std::vector<FileCoverage> result;
+  result.reserve(files.size());
+  for (auto const& [filename, data] : files) {
+    auto& file = result.emplace_back(filename);
+    for (std::size_t line = 0; line < data.hits.size(); ++line) {
+      if (data.is_known(line)) {
+        file.coverage.push_back({line, std::size_t(data.hits[line])});
+      }
+    }
+  }
+  return result;
+}
+
+CoverageTable& coverage_table() {
+  static CoverageTable table;
+  return table;
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <rsl/testing/result.hpp>
+
+namespace rsl::testing::_testing_impl {
+//? merges per-case coverage into one dense table per file as results are taken
+//? this keeps large coverage runs from holding a line table for every case
+class CoverageTable {
+  struct FileData {
+    std::vector<std::uint64_t> hits;   // indexed by line number
+    std::vector<std::uint64_t> known;  // bitmap of lines with instrumentation
+
+    void add(std::size_t line, std::uint64_t count);
+    [[nodiscard]] bool is_known(std::size_t line) const;
+  };
+
+  std::map<std::string, FileData, std::less<>> files;
+
+public:
+  void add(std::span<FileCoverage const> coverage);
+  void clear() { files.clear(); }
+
+  // every known line with its total count, ordered by file name and line
+  [[nodiscard]] std::vector<FileCoverage> lines() const;
+};
+
+//? coverage runs are always serial, so this is not synchronized
+CoverageTable& coverage_table();
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,180 @@
+#include "executor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "coverage/coverage.hpp"
+
+namespace rsl::testing::_testing_impl {
+namespace {
+//? per-worker range of pending work, packed into a single word so both ends can be
+//? claimed with one CAS. The owner pops from the front, thieves pop from the back.
+struct alignas(64) WorkRange {
+  std::atomic<std::uint64_t> bounds{0};
+
+  static constexpr std::uint64_t pack(std::uint32_t begin, std::uint32_t end) {
+    return (std::uint64_t(begin) << 32U) | end;
+  }
+
+  void assign(std::uint32_t begin, std::uint32_t end) {
+    bounds.store(pack(begin, end), std::memory_order_relaxed);
+  }
+
+  bool pop_front(std::uint32_t& out) {
+    auto current = bounds.load(std::memory_order_acquire);
+    while (true) {
+      auto begin = std::uint32_t(current >> 32U);
+      auto end   = std::uint32_t(current);
+      if (begin >= end) {
+        return false;
+      }
+      if (bounds.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+        out = begin;
+        return true;
+      }
+    }
+  }
+
+  bool pop_back(std::uint32_t& out) {
+    auto current = bounds.load(std::memory_order_acquire);
+    while (true) {
+      auto begin = std::uint32_t(current >> 32U);
+      auto end   = std::uint32_t(current);
+      if (begin >= end) {
+        return false;
+      }
+      if (bounds.compare_exchange_weak(current, pack(begin, end - 1), std::memory_order_acq_rel)) {
+        out = end - 1;
+        return true;
+      }
+    }
+  }
+};
+
+struct Slot {
+  std::atomic<bool> done{false};
+  std::optional<Result> result;
+};
+
+class ThreadPoolExecutor : public Executor {
+  std::span<TestCase const> cases;
+  std::vector<std::uint32_t> order;  // indices of cases that may run concurrently
+  std::unique_ptr<Slot[]> slots;
+  std::unique_ptr<WorkRange[]> queues;
+  std::size_t worker_count;
+  std::vector<std::jthread> workers;
+
+  void work(std::size_t self) {
+    std::uint32_t position = 0;
+    while (true) {
+      bool found = queues[self].pop_front(position);
+      for (std::size_t offset = 1; !found && offset < worker_count; ++offset) {
+        found = queues[(self + offset) % worker_count].pop_back(position);
+      }
+      if (!found) {
+        // no new work is ever submitted, so all queues being empty means we're done
+        return;
+      }
+
+      auto index = order[position];
+      auto& slot = slots[index];
+      slot.result.emplace(cases[index].run());
+      slot.done.store(true, std::memory_order_release);
+      slot.done.notify_one();
+    }
+  }
+
+public:
+  ThreadPoolExecutor(std::span<TestCase const> cases,
+                     std::span<double const> costs,
+                     std::size_t jobs)
+      : cases(cases)
+      , slots(new Slot[cases.size()])
+      , worker_count(jobs) {
+    for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+      if (!cases[idx].test->serial) {
+        order.push_back(std::uint32_t(idx));
+      }
+    }
+
+    queues = std::make_unique<WorkRange[]>(jobs);
+    if (costs.empty()) {
+      // hand out contiguous chunks so the cases needed first are also started first
+      for (std::size_t idx = 0; idx < jobs; ++idx) {
+        queues[idx].assign(std::uint32_t(order.size() * idx / jobs),
+                           std::uint32_t(order.size() * (idx + 1) / jobs));
+      }
+    } else {
+      // longest first: deal the sorted cases round-robin, every worker starts with its
+      // longest case while thieves take the shortest ones from the back
+      auto by_cost = [&](std::uint32_t idx) { return costs[idx]; };
+      std::ranges::stable_sort(order, std::greater{}, by_cost);
+      std::vector<std::uint32_t> dealt;
+      dealt.reserve(order.size());
+      for (std::size_t idx = 0; idx < jobs; ++idx) {
+        auto begin = dealt.size();
+        for (auto position = idx; position < order.size(); position += jobs) {
+          dealt.push_back(order[position]);
+        }
+        queues[idx].assign(std::uint32_t(begin), std::uint32_t(dealt.size()));
+      }
+      order = std::move(dealt);
+    }
+
+    workers.resize(jobs);
+    for (std::size_t idx = 0; idx < jobs; ++idx) {
+      workers[idx] = std::jthread([this, idx] { work(idx); });
+    }
+  }
+
+  ~ThreadPoolExecutor() override { drain(); }
+
+  void drain() {
+    for (auto& worker : workers) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+  }
+
+  Result take(std::size_t index) override {
+    if (cases[index].test->serial) {
+      // serial cases run on the calling thread once every concurrent case is done
+      drain();
+      return cases[index].run();
+    }
+
+    auto& slot = slots[index];
+    slot.done.wait(false, std::memory_order_acquire);
+    return std::move(*slot.result);
+  }
+};
+}  // namespace
+
+std::unique_ptr<Executor> make_executor(RunConfig const& config,
+                                        std::span<TestCase const> cases,
+                                        std::span<double const> costs) {
+  auto jobs = config.jobs == 0 ? std::size_t(std::thread::hardware_concurrency()) : config.jobs;
+  jobs      = std::min(jobs, cases.size());
+
+  if (config.isolate && !cases.empty()) {
+#ifdef _WIN32
+    throw std::runtime_error("process isolation is not supported on this platform");
+#else
+    return make_process_pool(config, cases, std::max(jobs, std::size_t{1}));
+#endif
+  }
+
+  //? coverage counters are global and not thread safe, always run serially with coverage
+  if (jobs <= 1 || _rsl_test_run_with_coverage != nullptr) {
+    return std::make_unique<SerialExecutor>(cases);
+  }
+  return std::make_unique<ThreadPoolExecutor>(cases, costs, jobs);
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <span>
+
+#include <rsl/testing/test.hpp>
+#include <rsl/testing/result.hpp>
+
+namespace rsl::testing::_testing_impl {
+class Executor {
+public:
+  virtual ~Executor() = default;
+
+  // blocks until the case at `index` has finished
+  // every index must be taken exactly once
+  virtual Result take(std::size_t index) = 0;
+};
+
+// runs every case on the calling thread as it is taken
+class SerialExecutor : public Executor {
+  std::span<TestCase const> cases;
+
+public:
+  explicit SerialExecutor(std::span<TestCase const> cases) : cases(cases) {}
+  Result take(std::size_t index) override { return cases[index].run(); }
+};
+
+// runs cases in `jobs` forked worker processes, see isolate.cpp
+std::unique_ptr<Executor> make_process_pool(RunConfig const& config,
+                                            std::span<TestCase const> cases,
+                                            std::size_t jobs);
+
+// `costs` are the expected durations of `cases` if known, empty otherwise
+std::unique_ptr<Executor> make_executor(RunConfig const& config,
+                                        std::span<TestCase const> cases,
+                                        std::span<double const> costs = {});
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <format>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rsl/testing/assert.hpp>
+
+#include <cpptrace/basic.hpp>
+#include <cpptrace/utils.hpp>
+
+namespace rsl::testing {
+namespace {
+//? symbolizing is by far the most expensive part of reporting a failure
+//? failing tests usually share most of their frames, so resolved frames are kept for the
+//? whole process. Reporters may run on their own thread, hence the lock
+class FrameCache {
+  std::mutex mutex;
+  std::unordered_map<std::uintptr_t, std::vector<cpptrace::stacktrace_frame>> frames;
+
+public:
+  // resolve all addresses not seen before in a single batch
+  std::vector<cpptrace::stacktrace_frame> resolve(std::span<std::uintptr_t const> trace) {
+    auto lock = std::lock_guard(mutex);
+
+    std::vector<cpptrace::frame_ptr> missing;
+    for (auto pc : trace) {
+      if (!frames.contains(pc) && !std::ranges::contains(missing, pc)) {
+        missing.push_back(pc);
+      }
+    }
+
+    if (!missing.empty()) {
+      auto resolved = cpptrace::raw_trace{missing}.resolve();
+      // every pc yields zero or more inlined frames followed by exactly one regular frame
+      std::size_t current = 0;
+      for (auto& frame : resolved.frames) {
+        if (current >= missing.size()) {
+          break;
+        }
+        bool const group_end = !frame.is_inline;
+        frames[missing[current]].push_back(std::move(frame));
+        if (group_end) {
+          ++current;
+        }
+      }
+      // anything cpptrace could not resolve is not worth asking for again
+      for (; current < missing.size(); ++current) {
+        frames.try_emplace(missing[current]);
+      }
+    }
+
+    std::vector<cpptrace::stacktrace_frame> result;
+    for (auto pc : trace) {
+      result.append_range(frames[pc]);
+    }
+    return result;
+  }
+};
+
+FrameCache& frame_cache() {
+  static FrameCache cache;
+  return cache;
+}
+
+std::string format_trace(assertion_failure const& failure) {
+  if (failure.trace.empty()) {
+    return {};
+  }
+
+  // the innermost frame belongs to libassert, everything past the test itself is runner noise
+  auto trace = cpptrace::stacktrace{};
+  for (auto& frame : frame_cache().resolve(std::span(failure.trace).subspan(1))) {
+    auto const done = cpptrace::prune_symbol(frame.symbol) == failure.test_name;
+    trace.frames.push_back(std::move(frame));
+    if (done) {
+      break;
+    }
+  }
+  return trace.to_string(false);
+}
+
+std::string format(assertion_failure const& failure) {
+  auto message = std::format("{} at {}:{}:", failure.action, failure.sloc.file, failure.sloc.line);
+  if (!failure.note.empty()) {
+    message += " " + failure.note;
+  }
+  message += std::format("\n    {}({});\n", failure.macro, failure.expression);
+
+  bool where = false;
+  for (auto const& [expression, value] : failure.diagnostics) {
+    if (expression == value) {
+      // literals explain themselves
+      continue;
+    }
+    if (!where) {
+      message += "    Where:\n";
+      where = true;
+    }
+    message += std::format("        {} => {}\n", expression, value);
+  }
+  return message + format_trace(failure);
+}
+}  // namespace
+
+std::string const& assertion_failure::message() const {
+  if (!formatted) {
+    formatted = format(*this);
+  }
+  return *formatted;
+}
+}  // namespace rsl::testing
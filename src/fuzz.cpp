@@ -0,0 +1,332 @@
+#include "fuzz.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <rsl/testing/assert.hpp>
+
+#include "corpus.hpp"
+#include "schedule.hpp"
+#include "alloc/allocations.hpp"
+#include "coverage/coverage.hpp"
+
+namespace rsl::testing::_testing_impl {
+namespace {
+// boundary values that commonly trigger edge cases in integer handling
+constexpr auto interesting_values = std::array<std::int64_t, 20>{
+    0, 1, -1, 16, 32, 64, 100, 127, -128, 255, 256, 1024, 4096, 32767, -32768, 65535,
+    INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN};
+
+struct Execution {
+  FuzzTarget const* target;
+  std::span<std::uint8_t const> input;
+  mutable int status = 0;
+};
+
+void execute(void const* data) {
+  auto const* execution = static_cast<Execution const*>(data);
+  auto counting         = rsl::alloc::CountingSection(true);
+  execution->status     = execution->target->run(execution->input.data(), execution->input.size());
+}
+
+class Fuzzer {
+  using clock = std::chrono::steady_clock;
+
+  FuzzTarget const& target;
+  FuzzSettings const& settings;
+  FuzzResult& stats;
+  std::optional<CorpusDirectory> directory;
+  FuzzExchange* exchange = nullptr;
+
+  std::mt19937_64 rng;
+  std::vector<std::vector<std::uint8_t>> corpus;
+  std::vector<std::uint8_t> buffer;
+  std::size_t size = 0;
+
+  // without rsltest_cov there is no feedback, inputs are mutated blindly
+  bool feedback = _rsl_test_run_with_feedback != nullptr;
+  clock::time_point start;
+
+  std::size_t random(std::size_t bound) { return bound == 0 ? 0 : std::size_t(rng() % bound); }
+
+  void load(std::span<std::uint8_t const> input) {
+    size = std::min(input.size(), buffer.size());
+    std::copy_n(input.begin(), size, buffer.begin());
+  }
+
+  // replaces the tail of the current input with the tail of another corpus entry
+  void crossover() {
+    auto const& other = corpus[random(corpus.size())];
+    auto cut          = random(size + 1);
+    auto from         = random(other.size() + 1);
+    auto count        = std::min(other.size() - from, buffer.size() - cut);
+    std::copy_n(other.begin() + std::ptrdiff_t(from), count, buffer.begin() + std::ptrdiff_t(cut));
+    size = cut + count;
+  }
+
+  void mutate() {
+    if (feedback || random(64) == 0) {
+      load(corpus[random(corpus.size())]);
+      if (corpus.size() > 1 && random(8) == 0) {
+        crossover();
+      }
+    }
+    // otherwise this is a random walk starting from the previous input
+
+    auto count = 1 + random(4);
+    for (std::size_t idx = 0; idx < count; ++idx) {
+      size = target.mutate(buffer.data(), size, buffer.size(), unsigned(rng()));
+    }
+  }
+
+  // returns whether the current input reached new coverage
+  bool run_input() {
+    assertion_counter().clear();
+    auto execution = Execution{&target, std::span(buffer.data(), size)};
+    if (exchange != nullptr) {
+      exchange->current(execution.input);
+    }
+    ++stats.runs;
+    try {
+      if (!feedback) {
+        execute(&execution);
+        assertion_counter().raise();
+        return false;
+      }
+      auto found = _rsl_test_run_with_feedback(execute, &execution);
+      assertion_counter().raise();
+      stats.features += found;
+      // targets may return -1 to reject an input, it is never added to the corpus
+      return found != 0 && execution.status != -1;
+    } catch (...) {
+      stats.crash.assign(buffer.begin(), buffer.begin() + std::ptrdiff_t(size));
+      stats.crash_arguments = target.describe(buffer.data(), size);
+      if (directory) {
+        stats.crash_file = directory->save_crash(stats.crash);
+      }
+      throw;
+    }
+  }
+
+  void keep_input() {
+    corpus.emplace_back(buffer.begin(), buffer.begin() + std::ptrdiff_t(size));
+    if (directory) {
+      directory->save(corpus.back());
+    }
+    if (exchange != nullptr) {
+      exchange->publish(corpus.back());
+    }
+  }
+
+  // inputs found by other processes only count if they add coverage here as well
+  void receive_inputs() {
+    exchange->receive([&](std::span<std::uint8_t const> input) {
+      load(input);
+      if (run_input()) {
+        corpus.emplace_back(buffer.begin(), buffer.begin() + std::ptrdiff_t(size));
+      }
+    });
+  }
+
+  // smallest inputs are replayed first, so minimization keeps the smallest ones
+  void load_corpus() {
+    for (auto const& input : directory->load()) {
+      load(input.data);
+      if (run_input()) {
+        corpus.emplace_back(buffer.begin(), buffer.begin() + std::ptrdiff_t(size));
+      } else if (!feedback) {
+        // nothing to judge the input by, keep everything
+        corpus.push_back(input.data);
+      } else if (settings.minimize) {
+        directory->remove(input);
+      }
+    }
+  }
+
+  [[nodiscard]] bool exhausted() const {
+    if (exchange != nullptr && exchange->stopped()) {
+      return true;
+    }
+    if (settings.runs != 0 && stats.runs >= settings.runs) {
+      return true;
+    }
+    return settings.time_s > 0 &&
+           std::chrono::duration<double>(clock::now() - start).count() >= settings.time_s;
+  }
+
+  void finish() {
+    stats.corpus_size = corpus.size();
+    stats.duration_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+
+public:
+  Fuzzer(TestCase const& test_case,
+         FuzzSettings const& settings,
+         FuzzResult& stats,
+         FuzzExchange* exchange)
+      : target(test_case.fuzz)
+      , settings(settings)
+      , stats(stats)
+      , exchange(exchange)
+      , buffer(std::max(settings.max_len, std::size_t{1})) {
+    stats.seed = settings.seed != 0 ? settings.seed : std::random_device{}();
+    rng.seed(stats.seed);
+    if (!settings.corpus.empty()) {
+      directory.emplace(settings.corpus, case_id(test_case));
+    }
+  }
+
+  void run() {
+    if (feedback) {
+      _rsl_test_reset_feedback();
+    }
+    start = clock::now();
+    try {
+      // the empty input always seeds the corpus
+      corpus.emplace_back();
+      run_input();
+      if (directory) {
+        load_corpus();
+      }
+
+      while (settings.enabled && !exhausted()) {
+        if (exchange != nullptr && stats.runs % 256 == 0) {
+          receive_inputs();
+        }
+        mutate();
+        if (run_input()) {
+          keep_input();
+        }
+      }
+    } catch (...) {
+      finish();
+      throw;
+    }
+    finish();
+  }
+};
+
+template <typename T>
+void mutate_integer(std::uint8_t* data, std::minstd_rand& rng) {
+  T value{};
+  std::memcpy(&value, data, sizeof(T));
+  auto delta = T(1 + rng() % 35);
+  value      = rng() % 2 == 0 ? T(value + delta) : T(value - delta);
+  std::memcpy(data, &value, sizeof(T));
+}
+}  // namespace
+
+FuzzSettings& fuzz_settings() {
+  static FuzzSettings settings{};
+  return settings;
+}
+
+void fuzz(TestCase const& test_case,
+          FuzzSettings const& settings,
+          FuzzResult& stats,
+          FuzzExchange* exchange) {
+  if (settings.enabled && settings.jobs > 1 && exchange == nullptr) {
+#ifdef _WIN32
+    throw std::runtime_error("parallel fuzzing is not supported on this platform");
+#else
+    fuzz_parallel(test_case, settings, stats);
+    return;
+#endif
+  }
+  Fuzzer(test_case, settings, stats, exchange).run();
+}
+
+std::size_t mutate_bytes(std::uint8_t* data,
+                         std::size_t size,
+                         std::size_t max_size,
+                         unsigned seed) {
+  enum Operation : std::uint8_t {
+    Insert,
+    Erase,
+    Change,
+    FlipBit,
+    Interesting,
+    Arithmetic,
+    Copy,
+    Shuffle
+  };
+
+  auto rng    = std::minstd_rand(seed);
+  auto random = [&](std::size_t bound) { return std::size_t(rng() % bound); };
+
+  auto operation = size == 0 ? Insert : Operation(random(8));
+  if (operation == Insert && size >= max_size) {
+    operation = Change;
+  }
+
+  // width of an integer at a random position, at most `size` bytes
+  auto width = [&] {
+    std::size_t result = std::size_t{1} << random(4);
+    while (result > size) {
+      result /= 2;
+    }
+    return result;
+  };
+
+  switch (operation) {
+    case Insert: {
+      auto count = std::min(1 + random(4), max_size - size);
+      auto pos   = random(size + 1);
+      std::memmove(data + pos + count, data + pos, size - pos);
+      auto byte = std::uint8_t(rng());
+      for (std::size_t idx = 0; idx < count; ++idx) {
+        // repeated bytes are more likely to trigger length or run handling
+        data[pos + idx] = random(2) == 0 ? byte : std::uint8_t(rng());
+      }
+      return size + count;
+    }
+    case Erase: {
+      auto count = 1 + random(std::min<std::size_t>(size, 8));
+      auto pos   = random(size - count + 1);
+      std::memmove(data + pos, data + pos + count, size - pos - count);
+      return size - count;
+    }
+    case Change: data[random(size)] = std::uint8_t(rng()); return size;
+    case FlipBit: data[random(size)] ^= std::uint8_t(1U << random(8)); return size;
+    case Interesting: {
+      auto bytes = width();
+      auto value = interesting_values[random(interesting_values.size())];
+      std::memcpy(data + random(size - bytes + 1), &value, bytes);
+      return size;
+    }
+    case Arithmetic: {
+      auto bytes = width();
+      auto* pos  = data + random(size - bytes + 1);
+      switch (bytes) {
+        case 1: mutate_integer<std::uint8_t>(pos, rng); break;
+        case 2: mutate_integer<std::uint16_t>(pos, rng); break;
+        case 4: mutate_integer<std::uint32_t>(pos, rng); break;
+        default: mutate_integer<std::uint64_t>(pos, rng); break;
+      }
+      return size;
+    }
+    case Copy: {
+      auto count = 1 + random(size);
+      auto from  = random(size - count + 1);
+      auto to    = random(size - count + 1);
+      std::memmove(data + to, data + from, count);
+      return size;
+    }
+    case Shuffle: {
+      auto count = 1 + random(std::min<std::size_t>(size, 8));
+      auto pos   = random(size - count + 1);
+      std::shuffle(data + pos, data + pos + count, rng);
+      return size;
+    }
+  }
+  return size;
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+#include <rsl/testing/result.hpp>
+#include <rsl/testing/test.hpp>
+
+namespace rsl::testing::_testing_impl {
+struct FuzzSettings {
+  bool enabled        = false;  // otherwise only the empty input and the corpus are replayed
+  std::size_t runs    = 10'000;
+  double time_s       = 0;
+  std::size_t max_len = 4096;
+  std::uint64_t seed  = 0;
+  std::string corpus;
+  bool minimize    = false;
+  std::size_t jobs = 1;  // worker processes
+};
+
+FuzzSettings& fuzz_settings();
+
+// lets fuzzers of the same target in several processes share their progress
+class FuzzExchange {
+public:
+  virtual ~FuzzExchange() = default;
+
+  virtual void publish(std::span<std::uint8_t const> input) = 0;
+  // calls `fnc` for every input other fuzzers published since the last call
+  virtual void receive(std::function<void(std::span<std::uint8_t const>)> const& fnc) = 0;
+  // the input about to run, recovered by the parent if this process dies
+  virtual void current(std::span<std::uint8_t const> input) = 0;
+  [[nodiscard]] virtual bool stopped() const = 0;
+};
+
+// mutate inputs of `target` until the budget is exhausted or the target fails
+// unless `settings.enabled` is set this only replays the empty input and the corpus
+// `stats` is kept up to date so it is meaningful even if this throws
+void fuzz(TestCase const& test_case,
+          FuzzSettings const& settings,
+          FuzzResult& stats,
+          FuzzExchange* exchange = nullptr);
+
+// runs `settings.jobs` forked fuzzers sharing their corpus, see fuzz_jobs.cpp
+void fuzz_parallel(TestCase const& test_case, FuzzSettings const& settings, FuzzResult& stats);
+}  // namespace rsl::testing::_testing_impl
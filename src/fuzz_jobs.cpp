@@ -0,0 +1,357 @@
+#include "fuzz.hpp"
+#include "corpus.hpp"
+#include "ipc.hpp"
+#include "schedule.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <new>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <rsl/testing/assert.hpp>
+
+//? every worker is a forked copy of this process, so coverage state is never shared
+//? interesting inputs are exchanged through a ring buffer in anonymous shared memory.
+//? Entries are published like a seqlock: readers copy an entry and check that its
+//? sequence did not change meanwhile. Entries overwritten before a worker got to them are
+//? skipped, the publishing worker still keeps them in its own corpus.
+
+namespace rsl::testing::_testing_impl {
+namespace {
+constexpr std::size_t ring_capacity = 1024;
+
+struct Header {
+  std::atomic<bool> stop{false};
+  std::atomic<std::uint64_t> published{0};
+};
+
+struct Slot {
+  std::atomic<std::uint64_t> sequence{0};  // index + 1 of the entry, 0 while being written
+  std::uint32_t worker = 0;
+  std::uint32_t size   = 0;
+  // followed by `max_len` bytes of data
+
+  std::uint8_t* data() { return reinterpret_cast<std::uint8_t*>(this + 1); }
+};
+
+class SharedMemory {
+  void* base         = MAP_FAILED;
+  std::size_t length = 0;
+
+public:
+  explicit SharedMemory(std::size_t length) : length(length) {
+    base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      throw std::runtime_error(std::string("mmap failed: ") + std::strerror(errno));
+    }
+  }
+  SharedMemory(SharedMemory const&)            = delete;
+  SharedMemory& operator=(SharedMemory const&) = delete;
+  ~SharedMemory() { munmap(base, length); }
+
+  [[nodiscard]] std::uint8_t* data() const { return static_cast<std::uint8_t*>(base); }
+};
+
+// layout: header, `ring_capacity` shared entries, then one slot per worker for its current input
+class SharedExchange : public FuzzExchange {
+  std::uint8_t* base;
+  std::size_t stride;
+  std::size_t max_len;
+  std::uint32_t worker;
+  std::uint64_t cursor = 0;
+  std::vector<std::uint8_t> scratch;
+
+  [[nodiscard]] Header& header() const { return *reinterpret_cast<Header*>(base); }
+
+public:
+  SharedExchange(std::uint8_t* base, std::size_t max_len, std::uint32_t worker)
+      : base(base)
+      , stride(stride_for(max_len))
+      , max_len(max_len)
+      , worker(worker) {}
+
+  static std::size_t stride_for(std::size_t max_len) {
+    auto size = sizeof(Slot) + max_len;
+    return (size + 63) & ~std::size_t{63};
+  }
+
+  static std::size_t size_for(std::size_t max_len, std::size_t jobs) {
+    return stride_for(max_len) * (1 + ring_capacity + jobs);
+  }
+
+  static void initialize(std::uint8_t* base, std::size_t max_len, std::size_t jobs) {
+    new (base) Header{};
+    for (std::size_t idx = 0; idx < ring_capacity + jobs; ++idx) {
+      new (base + stride_for(max_len) * (1 + idx)) Slot{};
+    }
+  }
+
+  [[nodiscard]] Slot& slot(std::size_t index) const {
+    return *reinterpret_cast<Slot*>(base + stride * (1 + index));
+  }
+
+  [[nodiscard]] Slot& current_slot(std::uint32_t owner) const {
+    return slot(ring_capacity + owner);
+  }
+
+  void publish(std::span<std::uint8_t const> input) override {
+    auto index  = header().published.fetch_add(1, std::memory_order_relaxed);
+    auto& entry = slot(index % ring_capacity);
+
+    entry.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.worker = worker;
+    entry.size   = std::uint32_t(std::min(input.size(), max_len));
+    std::memcpy(entry.data(), input.data(), entry.size);
+    entry.sequence.store(index + 1, std::memory_order_release);
+  }
+
+  void receive(std::function<void(std::span<std::uint8_t const>)> const& fnc) override {
+    auto published = header().published.load(std::memory_order_acquire);
+    cursor         = std::max(cursor, published > ring_capacity ? published - ring_capacity : 0);
+
+    for (; cursor < published; ++cursor) {
+      auto& entry   = slot(cursor % ring_capacity);
+      auto sequence = entry.sequence.load(std::memory_order_acquire);
+      if (sequence < cursor + 1) {
+        // still being written, try again next time
+        break;
+      }
+      if (sequence != cursor + 1 || entry.worker == worker) {
+        continue;
+      }
+
+      auto size = std::min<std::size_t>(entry.size, max_len);
+      scratch.assign(entry.data(), entry.data() + size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (entry.sequence.load(std::memory_order_relaxed) != sequence) {
+        // overwritten while copying
+        continue;
+      }
+      fnc(scratch);
+    }
+  }
+
+  void current(std::span<std::uint8_t const> input) override {
+    auto& entry = current_slot(worker);
+    entry.size  = std::uint32_t(std::min(input.size(), max_len));
+    std::memcpy(entry.data(), input.data(), entry.size);
+  }
+
+  [[nodiscard]] bool stopped() const override {
+    return header().stop.load(std::memory_order_relaxed);
+  }
+
+  void stop() const { header().stop.store(true, std::memory_order_relaxed); }
+};
+
+[[noreturn]] void worker_main(TestCase const& test_case,
+                              FuzzSettings const& settings,
+                              SharedExchange& exchange,
+                              int result_fd) {
+  FuzzResult stats;
+  std::string error;
+  try {
+    fuzz(test_case, settings, stats, &exchange);
+  } catch (assertion_failure const& failure) {
+    error = failure.message();
+  } catch (std::exception const& exc) {
+    error = exc.what();
+  } catch (...) { error = "unknown exception thrown"; }
+
+  bool const failed = !error.empty() || !stats.crash.empty();
+  if (failed) {
+    // one failure is enough, stop the others
+    exchange.stop();
+  }
+
+  Writer out;
+  out.write(failed);
+  out.write(error);
+  serialize(out, stats);
+  write_frame(result_fd, out.data());
+  // skip static destructors and atexit handlers, they belong to the parent
+  _exit(0);
+}
+
+struct Worker {
+  pid_t pid     = -1;
+  int result_fd = -1;
+};
+
+struct Failure {
+  std::uint32_t worker = 0;
+  std::vector<std::uint8_t> input;
+  std::optional<std::string> message;  // failed with an exception
+  std::string crash_file;
+  int status = 0;  // otherwise the wait status of the dead worker
+};
+}  // namespace
+
+void fuzz_parallel(TestCase const& test_case, FuzzSettings const& settings, FuzzResult& stats) {
+  auto const jobs    = settings.jobs;
+  auto const max_len = std::max(settings.max_len, std::size_t{1});
+  auto const start   = std::chrono::steady_clock::now();
+
+  auto memory = SharedMemory(SharedExchange::size_for(max_len, jobs));
+  SharedExchange::initialize(memory.data(), max_len, jobs);
+  auto parent = SharedExchange(memory.data(), max_len, 0);
+
+  stats.seed = settings.seed != 0 ? settings.seed : std::random_device{}();
+  // a worker that died must not take the runner with it
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::vector<Worker> workers;
+  workers.reserve(jobs);
+  for (std::uint32_t idx = 0; idx < jobs; ++idx) {
+    int reports[2];
+    if (pipe(reports) != 0) {
+      parent.stop();
+      throw std::runtime_error(std::string("pipe failed: ") + std::strerror(errno));
+    }
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    auto pid = fork();
+    if (pid < 0) {
+      parent.stop();
+      throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+    }
+
+    if (pid == 0) {
+      for (auto const& other : workers) {
+        close(other.result_fd);
+      }
+      close(reports[0]);
+
+      auto worker_settings = settings;
+      worker_settings.jobs = 1;
+      worker_settings.seed = stats.seed + idx;
+      // the run budget is split, the time budget applies to every worker
+      worker_settings.runs = settings.runs == 0 ? 0 : (settings.runs + jobs - 1) / jobs;
+      // coverage is per worker, only one of them may judge which stored inputs are redundant
+      worker_settings.minimize = settings.minimize && idx == 0;
+
+      auto exchange = SharedExchange(memory.data(), max_len, idx);
+      worker_main(test_case, worker_settings, exchange, reports[1]);
+    }
+
+    close(reports[1]);
+    workers.push_back({.pid = pid, .result_fd = reports[0]});
+  }
+
+  std::optional<Failure> failure;
+  std::string frame;
+  std::size_t running = workers.size();
+  while (running != 0) {
+    std::vector<pollfd> fds;
+    std::vector<std::uint32_t> polled;
+    for (std::uint32_t idx = 0; idx < workers.size(); ++idx) {
+      if (workers[idx].pid > 0) {
+        fds.push_back({.fd = workers[idx].result_fd, .events = POLLIN, .revents = 0});
+        polled.push_back(idx);
+      }
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      parent.stop();
+      throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+    }
+
+    for (std::size_t idx = 0; idx < fds.size(); ++idx) {
+      if (fds[idx].revents == 0) {
+        continue;
+      }
+      auto& worker  = workers[polled[idx]];
+      bool reported = read_frame(worker.result_fd, frame);
+      close(worker.result_fd);
+      int status = 0;
+      waitpid(worker.pid, &status, 0);
+      worker.pid = -1;
+      --running;
+
+      if (!reported) {
+        // died without reporting, the input it was running is still in shared memory
+        parent.stop();
+        if (!failure) {
+          auto& current = parent.current_slot(polled[idx]);
+          failure       = Failure{.worker = polled[idx],
+                                  .input  = {current.data(), current.data() + current.size},
+                                  .status = status};
+        }
+        continue;
+      }
+
+      auto in          = Reader(frame);
+      auto failed      = in.read<bool>();
+      auto message     = std::string(in.read_string());
+      auto worker_stats = FuzzResult{};
+      deserialize(in, worker_stats);
+
+      stats.runs += worker_stats.runs;
+      // coverage is per worker, the best worker is the closest to the combined coverage
+      stats.features    = std::max(stats.features, worker_stats.features);
+      stats.corpus_size = std::max(stats.corpus_size, worker_stats.corpus_size);
+      if (failed && !failure) {
+        failure = Failure{.worker     = polled[idx],
+                          .input      = std::move(worker_stats.crash),
+                          .message    = std::move(message),
+                          .crash_file = std::move(worker_stats.crash_file)};
+      }
+    }
+  }
+  stats.duration_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  if (!failure) {
+    return;
+  }
+
+  stats.crash           = std::move(failure->input);
+  stats.crash_arguments = test_case.fuzz.describe(stats.crash.data(), stats.crash.size());
+  stats.crash_file      = std::move(failure->crash_file);
+  if (stats.crash_file.empty() && !settings.corpus.empty()) {
+    stats.crash_file = CorpusDirectory(settings.corpus, case_id(test_case)).save_crash(stats.crash);
+  }
+
+  if (!failure->message) {
+    auto status = failure->status;
+    if (WIFSIGNALED(status)) {
+      throw std::runtime_error(std::format("fuzz worker {} terminated by signal {} ({})",
+                                           failure->worker,
+                                           WTERMSIG(status),
+                                           strsignal(WTERMSIG(status))));
+    }
+    throw std::runtime_error(
+        std::format("fuzz worker {} exited with status {}", failure->worker, WEXITSTATUS(status)));
+  }
+
+  // replay here so the failure is reported exactly like a serial run would report it
+  assertion_counter().clear();
+  test_case.fuzz.run(stats.crash.data(), stats.crash.size());
+  assertion_counter().raise();
+  throw std::runtime_error(std::format("fuzz worker {} failed: {}\nthe input passed when replayed",
+                                       failure->worker,
+                                       *failure->message));
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,366 @@
+#include "history.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#  include <fcntl.h>
+#  include <io.h>
+#  include <sys/stat.h>
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/file.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace rsl::testing::_testing_impl {
+namespace {
+constexpr char magic[8]          = {'R', 'S', 'L', 'H', 'I', 'S', 'T', '1'};
+constexpr std::size_t header_size = sizeof(magic);
+
+enum class RecordKind : std::uint32_t { Name = 1, Sample = 2 };
+
+struct RecordHeader {
+  RecordKind kind;
+  std::uint32_t size;  // payload size, records are padded to 8 bytes
+};
+
+struct Sample {
+  std::uint64_t hash;
+  double duration_ms;
+  std::int64_t timestamp;
+  TestOutcome outcome;
+  std::uint8_t reserved[7] = {};  // explicit padding, always written as zeroes
+};
+static_assert(sizeof(Sample) == 32);
+
+constexpr std::size_t padded(std::size_t size) {
+  return (size + 7U) & ~std::size_t{7U};
+}
+
+std::uint64_t hash_id(std::string_view id) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (auto chr : id) {
+    hash ^= static_cast<unsigned char>(chr);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+void append_record(std::string& out, RecordKind kind, std::string_view payload) {
+  auto header = RecordHeader{kind, std::uint32_t(payload.size())};
+  out.append(reinterpret_cast<char const*>(&header), sizeof(header));
+  out.append(payload);
+  out.append(padded(payload.size()) - payload.size(), '\0');
+}
+
+void append_name(std::string& out, std::uint64_t hash, std::string_view id) {
+  std::string payload(reinterpret_cast<char const*>(&hash), sizeof(hash));
+  payload += id;
+  append_record(out, RecordKind::Name, payload);
+}
+
+void append_sample(std::string& out, Sample const& sample) {
+  append_record(out,
+                RecordKind::Sample,
+                {reinterpret_cast<char const*>(&sample), sizeof(sample)});
+}
+
+void apply_sample(HistoryEntry& entry, double duration_ms, TestOutcome outcome) {
+  if (entry.runs == 1) {
+    entry.baseline_ms = entry.duration_ms;
+  } else if (entry.runs > 1) {
+    entry.baseline_ms = 0.8 * entry.baseline_ms + 0.2 * entry.duration_ms;
+  }
+  entry.duration_ms = duration_ms;
+  entry.outcome     = outcome;
+  ++entry.runs;
+}
+
+std::int64_t now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// returns the number of records in `data`, which must not include the header
+std::size_t parse_records(std::string_view data,
+                          std::unordered_map<std::uint64_t, HistoryEntry>& entries) {
+  std::size_t count = 0;
+  while (data.size() >= sizeof(RecordHeader)) {
+    RecordHeader header{};
+    std::memcpy(&header, data.data(), sizeof(header));
+    data.remove_prefix(sizeof(header));
+    if (padded(header.size) > data.size()) {
+      // torn write at the end of the file, ignore it
+      break;
+    }
+    auto payload = data.substr(0, header.size);
+    data.remove_prefix(padded(header.size));
+    ++count;
+
+    if (header.kind == RecordKind::Name && payload.size() >= sizeof(std::uint64_t)) {
+      std::uint64_t hash = 0;
+      std::memcpy(&hash, payload.data(), sizeof(hash));
+      entries[hash].id = payload.substr(sizeof(hash));
+    } else if (header.kind == RecordKind::Sample && payload.size() == sizeof(Sample)) {
+      Sample sample{};
+      std::memcpy(&sample, payload.data(), sizeof(sample));
+      apply_sample(entries[sample.hash], sample.duration_ms, sample.outcome);
+    }
+  }
+  return count;
+}
+
+bool has_magic(std::string_view data) {
+  return data.size() >= header_size && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+}
+
+//? shards share one history file. Every writer holds an exclusive lock on it while appending
+//? or compacting, so whoever finds the file empty under the lock writes the only header.
+//? Compaction replaces the file, a writer that waited for the lock on the replaced file
+//? notices and starts over with the new one
+class LockedFile {
+  int fd = -1;
+
+public:
+  explicit LockedFile(std::string const& path) {
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open file: " + path);
+    }
+    OVERLAPPED whole{};
+    LockFileEx(HANDLE(_get_osfhandle(fd)), LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &whole);
+#else
+    while (true) {
+      fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+      if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+      }
+      while (flock(fd, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+          ::close(fd);
+          throw std::runtime_error("Failed to lock file: " + path);
+        }
+      }
+
+      struct stat held{};
+      struct stat current{};
+      if (fstat(fd, &held) == 0 && ::stat(path.c_str(), &current) == 0 &&
+          held.st_dev == current.st_dev && held.st_ino == current.st_ino) {
+        return;
+      }
+      // compacted while waiting for the lock
+      ::close(fd);
+    }
+#endif
+  }
+
+  LockedFile(LockedFile const&)            = delete;
+  LockedFile& operator=(LockedFile const&) = delete;
+
+  ~LockedFile() {
+    // closing releases the lock
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+  }
+
+  [[nodiscard]] std::string read() const {
+    std::string data;
+#ifdef _WIN32
+    data.resize(std::size_t(_filelengthi64(fd)));
+    _lseeki64(fd, 0, SEEK_SET);
+    auto received = _read(fd, data.data(), unsigned(data.size()));
+    data.resize(received < 0 ? 0 : std::size_t(received));
+#else
+    struct stat info{};
+    fstat(fd, &info);
+    data.resize(std::size_t(info.st_size));
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+      auto received = pread(fd, data.data() + offset, data.size() - offset, off_t(offset));
+      if (received < 0 && errno == EINTR) {
+        continue;
+      }
+      if (received <= 0) {
+        break;
+      }
+      offset += std::size_t(received);
+    }
+    data.resize(offset);
+#endif
+    return data;
+  }
+
+  [[nodiscard]] bool empty() const {
+#ifdef _WIN32
+    return _filelengthi64(fd) == 0;
+#else
+    struct stat info{};
+    return fstat(fd, &info) == 0 && info.st_size == 0;
+#endif
+  }
+
+  void append(std::string_view data) const {
+    while (!data.empty()) {
+#ifdef _WIN32
+      auto written = _write(fd, data.data(), unsigned(data.size()));
+#else
+      auto written = ::write(fd, data.data(), data.size());
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+#endif
+      if (written <= 0) {
+        throw std::runtime_error("Failed to write test history");
+      }
+      data.remove_prefix(std::size_t(written));
+    }
+  }
+};
+}  // namespace
+
+History::History(std::string path) : path(std::move(path)), file(this->path) {
+  load();
+}
+
+void History::load() {
+  auto data = file.view();
+  if (data.empty()) {
+    return;
+  }
+  if (!has_magic(data)) {
+    throw std::runtime_error(path + " is not a test history file");
+  }
+  record_count = parse_records(data.substr(header_size), entries);
+}
+
+HistoryEntry const* History::find(std::string_view id) const {
+  auto it = entries.find(hash_id(id));
+  return it == entries.end() || it->second.runs == 0 ? nullptr : &it->second;
+}
+
+void History::record(std::string_view id, Result const& result) {
+  if (result.outcome == TestOutcome::SKIP) {
+    return;
+  }
+
+  auto hash   = hash_id(id);
+  auto& entry = entries[hash];
+  if (entry.id.empty()) {
+    entry.id = new_ids.emplace_back(id);
+    append_name(pending, hash, id);
+    ++record_count;
+  }
+  apply_sample(entry, result.duration_ms, result.outcome);
+  append_sample(pending, {hash, result.duration_ms, now(), result.outcome});
+  ++record_count;
+}
+
+void History::save() {
+  if (pending.empty()) {
+    return;
+  }
+
+  auto out = LockedFile(path);
+  if (out.empty()) {
+    out.append({magic, sizeof(magic)});
+  }
+#ifndef _WIN32
+  //? Windows cannot replace a file other shards hold open, it only ever appends
+  if (record_count > 8 * entries.size() + 1024) {
+    compact(out.read());
+    pending.clear();
+    return;
+  }
+#endif
+  out.append(pending);
+  pending.clear();
+}
+
+#ifndef _WIN32
+void History::compact(std::string current) const {
+  //? keep only the current state of every entry, the baseline is preserved as an extra sample
+  //? other shards may have appended since this run loaded the file, so the records are read
+  //? again under the lock and merged with this run's
+  if (!has_magic(current)) {
+    throw std::runtime_error(path + " is not a test history file");
+  }
+  current += pending;
+  std::unordered_map<std::uint64_t, HistoryEntry> merged;
+  parse_records(std::string_view(current).substr(header_size), merged);
+
+  std::string data(magic, sizeof(magic));
+  auto timestamp = now();
+  for (auto const& [hash, entry] : merged) {
+    if (entry.runs == 0 || entry.id.empty()) {
+      continue;
+    }
+    append_name(data, hash, entry.id);
+    if (entry.runs > 1) {
+      append_sample(data, {hash, entry.baseline_ms, timestamp, entry.outcome});
+    }
+    append_sample(data, {hash, entry.duration_ms, timestamp, entry.outcome});
+  }
+
+  auto temporary = std::format("{}.{}.tmp", path, getpid());
+  {
+    auto out = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      throw std::runtime_error("Failed to open file: " + temporary);
+    }
+    out.write(data.data(), std::streamsize(data.size()));
+  }
+  // still holding the lock on the old file, writers waiting for it will reopen
+  std::filesystem::rename(temporary, path);
+}
+#endif
+
+std::string History::report(std::size_t count) const {
+  std::vector<HistoryEntry const*> known;
+  for (auto const& [hash, entry] : entries) {
+    if (entry.runs != 0) {
+      known.push_back(&entry);
+    }
+  }
+
+  auto by_duration   = [](HistoryEntry const* entry) { return entry->duration_ms; };
+  auto by_regression = [](HistoryEntry const* entry) { return entry->regression_ms(); };
+
+  std::string output;
+  auto top = std::min(count, known.size());
+  std::ranges::partial_sort(known, known.begin() + top, std::greater{}, by_duration);
+  output += std::format("Slowest {} test cases:\n", top);
+  for (auto const* entry : known | std::views::take(top)) {
+    output += std::format("  {:>12.3f} ms  {}\n", entry->duration_ms, entry->id);
+  }
+
+  std::erase_if(known, [](auto* entry) { return entry->regression_ms() <= 0; });
+  top = std::min(count, known.size());
+  std::ranges::partial_sort(known, known.begin() + top, std::greater{}, by_regression);
+  output += "Biggest regressions:\n";
+  for (auto const* entry : known | std::views::take(top)) {
+    output += std::format("  {:>+12.3f} ms  {} ({:.3f} ms -> {:.3f} ms)\n",
+                          entry->regression_ms(),
+                          entry->id,
+                          entry->baseline_ms,
+                          entry->duration_ms);
+  }
+  return output;
+}
+}  // namespace rsl::testing::_testing_impl
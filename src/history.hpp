@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <rsl/testing/result.hpp>
+
+#include "mapped_file.hpp"
+
+namespace rsl::testing::_testing_impl {
+struct HistoryEntry {
+  std::string_view id;
+  double duration_ms  = 0;  // most recent run
+  double baseline_ms  = 0;  // moving average of the runs before that
+  std::uint32_t runs  = 0;
+  TestOutcome outcome = TestOutcome::PASS;
+
+  [[nodiscard]] double regression_ms() const { return runs < 2 ? 0 : duration_ms - baseline_ms; }
+};
+
+// append-only log of durations and outcomes per stable test case id
+//
+// The file is a header followed by records. A `Name` record introduces an id, `Sample`
+// records refer to it by hash. New samples are only ever appended, so concurrent shards
+// can share a file and updating it costs one write per run. Writers lock the file, which
+// is compacted once it has grown large.
+class History {
+  std::string path;
+  MappedFile file;
+  std::unordered_map<std::uint64_t, HistoryEntry> entries;
+  std::deque<std::string> new_ids;  // ids first seen during this run
+  std::string pending;              // encoded records not yet written
+  std::size_t record_count = 0;
+
+  void load();
+  void compact(std::string current) const;
+
+public:
+  explicit History(std::string path);
+
+  [[nodiscard]] HistoryEntry const* find(std::string_view id) const;
+  void record(std::string_view id, Result const& result);
+  void save();
+
+  // the `count` slowest cases and the `count` cases that slowed down the most
+  [[nodiscard]] std::string report(std::size_t count) const;
+};
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,158 @@
+#include "impact.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "ipc.hpp"
+#include "mapped_file.hpp"
+
+namespace rsl::testing::_testing_impl {
+namespace {
+constexpr char magic[8] = {'R', 'S', 'L', 'I', 'M', 'P', 'T', '1'};
+
+bool path_matches(std::string_view indexed, std::string_view changed) {
+  // coverage has absolute paths, changes are usually relative to the repository root
+  if (changed.starts_with("./")) {
+    changed.remove_prefix(2);
+  }
+  if (!indexed.ends_with(changed)) {
+    return false;
+  }
+  return indexed.size() == changed.size() || changed.starts_with('/') ||
+         indexed[indexed.size() - changed.size() - 1] == '/';
+}
+}  // namespace
+
+ImpactIndex::ImpactIndex(std::string path) : path(std::move(path)) {
+  load();
+}
+
+std::uint32_t ImpactIndex::file_id(std::string_view filename) {
+  auto [it, inserted] = file_ids.try_emplace(std::string(filename), std::uint32_t(files.size()));
+  if (inserted) {
+    files.emplace_back(filename);
+  }
+  return it->second;
+}
+
+void ImpactIndex::load() {
+  auto file = MappedFile(path);
+  auto data = file.view();
+  if (data.empty()) {
+    return;
+  }
+  if (data.size() < sizeof(magic) || std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+    throw std::runtime_error(path + " is not a test impact index");
+  }
+
+  auto in         = Reader(data.substr(sizeof(magic)));
+  auto file_count = in.read<std::uint64_t>();
+  for (std::uint64_t idx = 0; idx < file_count; ++idx) {
+    file_id(in.read_string());
+  }
+
+  auto test_count = in.read<std::uint64_t>();
+  for (std::uint64_t idx = 0; idx < test_count; ++idx) {
+    auto& footprints = tests[std::string(in.read_string())];
+    footprints.resize(in.read<std::uint64_t>());
+    for (auto& footprint : footprints) {
+      footprint.file = in.read<std::uint32_t>();
+      footprint.lines.resize(in.read<std::uint64_t>());
+      for (auto& range : footprint.lines) {
+        range.first  = in.read<std::uint32_t>();
+        range.second = in.read<std::uint32_t>();
+      }
+    }
+  }
+}
+
+void ImpactIndex::record(std::string const& id, std::span<FileCoverage const> coverage) {
+  auto& footprints = tests[id];
+  footprints.clear();
+  for (auto const& file : coverage) {
+    std::vector<std::uint32_t> lines;
+    lines.reserve(file.coverage.size());
+    for (auto const& line : file.coverage) {
+      lines.push_back(std::uint32_t(line.line));
+    }
+    std::ranges::sort(lines);
+
+    auto& footprint = footprints.emplace_back(file_id(file.filename));
+    for (auto line : lines) {
+      if (!footprint.lines.empty() && line <= footprint.lines.back().second + 1) {
+        footprint.lines.back().second = std::max(footprint.lines.back().second, line);
+      } else {
+        footprint.lines.emplace_back(line, line);
+      }
+    }
+  }
+  modified = true;
+}
+
+void ImpactIndex::save() const {
+  if (!modified) {
+    return;
+  }
+
+  Writer out;
+  out.write(std::uint64_t(files.size()));
+  for (auto const& file : files) {
+    out.write(file);
+  }
+  out.write(std::uint64_t(tests.size()));
+  for (auto const& [id, footprints] : tests) {
+    out.write(id);
+    out.write(std::uint64_t(footprints.size()));
+    for (auto const& footprint : footprints) {
+      out.write(footprint.file);
+      out.write(std::uint64_t(footprint.lines.size()));
+      for (auto const& [first, last] : footprint.lines) {
+        out.write(first);
+        out.write(last);
+      }
+    }
+  }
+
+  auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  file.write(magic, sizeof(magic));
+  file.write(out.data().data(), std::streamsize(out.data().size()));
+}
+
+ImpactIndex::Query::Query(ImpactIndex const& index, std::span<ChangedLines const> changes)
+    : index(&index)
+    , changes_by_file(index.files.size()) {
+  for (std::size_t file = 0; file < index.files.size(); ++file) {
+    for (auto const& change : changes) {
+      if (path_matches(index.files[file], change.file)) {
+        changes_by_file[file].push_back(&change);
+      }
+    }
+  }
+}
+
+bool ImpactIndex::Query::affected(std::string const& id) const {
+  auto it = index->tests.find(id);
+  if (it == index->tests.end()) {
+    return true;
+  }
+
+  for (auto const& footprint : it->second) {
+    for (auto const* change : changes_by_file[footprint.file]) {
+      // first range ending at or after the start of the change
+      auto range = std::ranges::lower_bound(footprint.lines,
+                                            change->first,
+                                            {},
+                                            [](auto const& lines) { return lines.second; });
+      if (range != footprint.lines.end() && range->first <= change->last) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+}  // namespace rsl::testing::_testing_impl
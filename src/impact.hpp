@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <rsl/testing/result.hpp>
+#include <rsl/testing/test.hpp>
+
+namespace rsl::testing::_testing_impl {
+// maps test case ids to the source lines they reached in the last coverage run
+class ImpactIndex {
+  struct Footprint {
+    std::uint32_t file;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> lines;  // closed, sorted ranges
+  };
+
+  std::string path;
+  std::vector<std::string> files;
+  std::unordered_map<std::string, std::uint32_t> file_ids;
+  std::unordered_map<std::string, std::vector<Footprint>> tests;
+  bool modified = false;
+
+  std::uint32_t file_id(std::string_view filename);
+  void load();
+
+public:
+  explicit ImpactIndex(std::string path);
+
+  [[nodiscard]] bool empty() const { return tests.empty(); }
+  void record(std::string const& id, std::span<FileCoverage const> coverage);
+  void save() const;
+
+  // true if the case reached any of the changed lines, or if nothing is known about it
+  class Query {
+    ImpactIndex const* index;
+    std::vector<std::vector<ChangedLines const*>> changes_by_file;
+
+  public:
+    Query(ImpactIndex const& index, std::span<ChangedLines const> changes);
+    [[nodiscard]] bool affected(std::string const& id) const;
+  };
+};
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <rsl/testing/result.hpp>
+
+namespace rsl::testing::_testing_impl {
+//? minimal binary (de)serialization for talking to worker processes
+//? both ends are always the same binary, so no care is taken about endianness or padding
+
+class Writer {
+  std::string buffer;
+
+public:
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void write(T const& value) {
+    buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+  }
+
+  void write(std::string_view str) {
+    write(std::uint64_t(str.size()));
+    buffer.append(str);
+  }
+
+  void write(std::string const& str) { write(std::string_view(str)); }
+
+  [[nodiscard]] std::string_view data() const { return buffer; }
+  void clear() { buffer.clear(); }
+};
+
+class Reader {
+  std::string_view buffer;
+
+  std::string_view consume(std::size_t size) {
+    if (size > buffer.size()) {
+      throw std::runtime_error("truncated message");
+    }
+    auto part = buffer.substr(0, size);
+    buffer.remove_prefix(size);
+    return part;
+  }
+
+public:
+  explicit Reader(std::string_view buffer) : buffer(buffer) {}
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  T read() {
+    T value;
+    std::memcpy(&value, consume(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  std::string_view read_string() { return consume(read<std::uint64_t>()); }
+
+  [[nodiscard]] bool empty() const { return buffer.empty(); }
+};
+
+// returns false if the peer went away before everything was transferred
+bool write_all(int fd, std::string_view data);
+bool read_all(int fd, char* data, std::size_t size);
+
+// frames are prefixed with their size
+bool write_frame(int fd, std::string_view data);
+bool read_frame(int fd, std::string& data);
+
+void serialize(Writer& out, FuzzResult const& fuzz);
+void deserialize(Reader& in, FuzzResult& fuzz);
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,559 @@
+#include "executor.hpp"
+#include "ipc.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace rsl::testing::_testing_impl {
+bool write_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    auto written = ::write(fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data.remove_prefix(std::size_t(written));
+  }
+  return true;
+}
+
+bool read_all(int fd, char* data, std::size_t size) {
+  while (size != 0) {
+    auto received = ::read(fd, data, size);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    data += received;
+    size -= std::size_t(received);
+  }
+  return true;
+}
+
+bool write_frame(int fd, std::string_view data) {
+  auto size = std::uint64_t(data.size());
+  return write_all(fd, {reinterpret_cast<char const*>(&size), sizeof(size)}) &&
+         write_all(fd, data);
+}
+
+bool read_frame(int fd, std::string& data) {
+  std::uint64_t size = 0;
+  if (!read_all(fd, reinterpret_cast<char*>(&size), sizeof(size))) {
+    return false;
+  }
+  data.resize(size);
+  return read_all(fd, data.data(), size);
+}
+
+void serialize(Writer& out, FuzzResult const& fuzz) {
+  out.write(fuzz.runs);
+  out.write(fuzz.corpus_size);
+  out.write(fuzz.features);
+  out.write(fuzz.seed);
+  out.write(fuzz.duration_ms);
+  out.write(std::string_view(reinterpret_cast<char const*>(fuzz.crash.data()), fuzz.crash.size()));
+  out.write(fuzz.crash_arguments);
+  out.write(fuzz.crash_file);
+}
+
+void deserialize(Reader& in, FuzzResult& fuzz) {
+  fuzz.runs        = in.read<std::size_t>();
+  fuzz.corpus_size = in.read<std::size_t>();
+  fuzz.features    = in.read<std::size_t>();
+  fuzz.seed        = in.read<std::uint64_t>();
+  fuzz.duration_ms = in.read<double>();
+  auto crash       = in.read_string();
+  fuzz.crash.assign(crash.begin(), crash.end());
+  fuzz.crash_arguments = in.read_string();
+  fuzz.crash_file      = in.read_string();
+}
+
+namespace {
+std::string_view intern(std::string_view str) {
+  //? string views in `Result` must outlive the worker that produced them
+  static std::unordered_set<std::string> pool;
+  return *pool.emplace(str).first;
+}
+
+//? workers are forks of this process, so the raw trace stays valid here and is only
+//? symbolized if a reporter asks for the message
+void serialize(Writer& out, assertion_failure const& failure) {
+  out.write(std::string_view(failure.sloc.file));
+  out.write(std::uint32_t(failure.sloc.line));
+  out.write(failure.action);
+  out.write(failure.macro);
+  out.write(failure.expression);
+  out.write(failure.note);
+  out.write(std::uint64_t(failure.diagnostics.size()));
+  for (auto const& [expression, value] : failure.diagnostics) {
+    out.write(expression);
+    out.write(value);
+  }
+  out.write(std::uint64_t(failure.trace.size()));
+  for (auto pc : failure.trace) {
+    out.write(pc);
+  }
+  out.write(failure.test_name);
+  out.write(failure.formatted.has_value());
+  if (failure.formatted) {
+    out.write(*failure.formatted);
+  }
+}
+
+void deserialize(Reader& in, std::vector<assertion_failure>& failures) {
+  auto file         = intern(in.read_string());
+  auto line         = in.read<std::uint32_t>();
+  auto& target      = failures.emplace_back(rsl::source_location(file.data(), "", line));
+  target.action     = intern(in.read_string());
+  target.macro      = intern(in.read_string());
+  target.expression = intern(in.read_string());
+  target.note       = in.read_string();
+  target.diagnostics.resize(in.read<std::uint64_t>());
+  for (auto& [expression, value] : target.diagnostics) {
+    expression = in.read_string();
+    value      = in.read_string();
+  }
+  target.trace.resize(in.read<std::uint64_t>());
+  for (auto& pc : target.trace) {
+    pc = in.read<std::uintptr_t>();
+  }
+  target.test_name = in.read_string();
+  if (in.read<bool>()) {
+    target.formatted = std::string(in.read_string());
+  }
+}
+
+void serialize(Writer& out, Result const& result) {
+  out.write(result.outcome);
+  out.write(result.duration_ms);
+  out.write(std::uint64_t(result.failures.size()));
+  for (auto const& failure : result.failures) {
+    serialize(out, failure);
+  }
+  out.write(result.exception);
+  out.write(result.stdout);
+  out.write(result.stderr);
+
+  out.write(std::uint64_t(result.assertions.size()));
+  for (auto const& assertion : result.assertions) {
+    out.write(assertion.raw);
+    out.write(assertion.expanded);
+    out.write(assertion.success);
+  }
+  out.write(result.assertions_passed);
+  out.write(result.assertions_failed);
+
+  out.write(result.benchmark.has_value());
+  if (result.benchmark) {
+    out.write(*result.benchmark);
+  }
+
+  out.write(result.fuzz.has_value());
+  if (result.fuzz) {
+    serialize(out, *result.fuzz);
+  }
+
+  out.write(result.allocations.has_value());
+  if (result.allocations) {
+    out.write(*result.allocations);
+  }
+
+  out.write(result.counters.has_value());
+  if (result.counters) {
+    out.write(*result.counters);
+  }
+
+  out.write(std::uint64_t(result.coverage.size()));
+  for (auto const& file : result.coverage) {
+    out.write(file.filename);
+    out.write(std::uint64_t(file.coverage.size()));
+    for (auto const& line : file.coverage) {
+      out.write(line);
+    }
+  }
+}
+
+void deserialize(Reader& in, Result& result) {
+  result.outcome     = in.read<TestOutcome>();
+  result.duration_ms = in.read<double>();
+  for (auto count = in.read<std::uint64_t>(); count != 0; --count) {
+    deserialize(in, result.failures);
+  }
+  result.exception = in.read_string();
+  result.stdout    = in.read_string();
+  result.stderr    = in.read_string();
+
+  result.assertions.resize(in.read<std::uint64_t>());
+  for (auto& assertion : result.assertions) {
+    assertion.raw      = intern(in.read_string());
+    assertion.expanded = intern(in.read_string());
+    assertion.success  = in.read<bool>();
+  }
+  result.assertions_passed = in.read<std::size_t>();
+  result.assertions_failed = in.read<std::size_t>();
+
+  if (in.read<bool>()) {
+    result.benchmark = in.read<BenchmarkResult>();
+  }
+
+  if (in.read<bool>()) {
+    deserialize(in, result.fuzz.emplace());
+  }
+
+  if (in.read<bool>()) {
+    result.allocations = in.read<AllocationResult>();
+  }
+
+  if (in.read<bool>()) {
+    result.counters = in.read<PerfResult>();
+  }
+
+  result.coverage.resize(in.read<std::uint64_t>());
+  for (auto& file : result.coverage) {
+    file.filename = in.read_string();
+    file.coverage.resize(in.read<std::uint64_t>());
+    for (auto& line : file.coverage) {
+      line = in.read<LineCoverage>();
+    }
+  }
+}
+
+void apply_cpu_limit(std::size_t seconds) {
+  //? RLIMIT_CPU counts the whole process lifetime, move the soft limit ahead for every test
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  rlimit limit{};
+  getrlimit(RLIMIT_CPU, &limit);
+  limit.rlim_cur = rlim_t(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + 1 + seconds);
+  setrlimit(RLIMIT_CPU, &limit);
+}
+
+void apply_memory_limit(std::size_t megabytes) {
+  rlimit limit{};
+  getrlimit(RLIMIT_AS, &limit);
+  limit.rlim_cur = rlim_t(megabytes) * 1024 * 1024;
+  setrlimit(RLIMIT_AS, &limit);
+}
+
+[[noreturn]] void worker_main(std::span<TestCase const> cases,
+                              int task_fd,
+                              int result_fd,
+                              RunConfig const& config) {
+  if (config.memory_limit != 0) {
+    apply_memory_limit(config.memory_limit);
+  }
+
+  Writer out;
+  std::uint32_t index = 0;
+  while (read_all(task_fd, reinterpret_cast<char*>(&index), sizeof(index))) {
+    if (config.cpu_limit != 0) {
+      apply_cpu_limit(config.cpu_limit);
+    }
+    auto result = cases[index].run();
+
+    out.clear();
+    out.write(index);
+    serialize(out, result);
+    if (!write_frame(result_fd, out.data())) {
+      break;
+    }
+  }
+  // skip static destructors and atexit handlers, they belong to the parent
+  // stdio buffers are the worker's own though, output the last case left in them is kept
+  std::fflush(nullptr);
+  _exit(0);
+}
+
+//? ignores a signal for its lifetime, the previous disposition is restored afterwards
+class IgnoredSignal {
+  int signal;
+  struct sigaction previous{};
+
+public:
+  explicit IgnoredSignal(int signal) : signal(signal) {
+    struct sigaction ignore{};
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(signal, &ignore, &previous);
+  }
+
+  IgnoredSignal(IgnoredSignal const&)            = delete;
+  IgnoredSignal& operator=(IgnoredSignal const&) = delete;
+  ~IgnoredSignal() { restore(); }
+
+  void restore() const { sigaction(signal, &previous, nullptr); }
+};
+
+struct Worker {
+  pid_t pid     = -1;
+  int task_fd   = -1;  // parent -> worker
+  int result_fd = -1;  // worker -> parent
+  std::optional<std::uint32_t> current;
+  std::chrono::steady_clock::time_point started;  // when `current` was handed out
+};
+
+class ProcessPoolExecutor : public Executor {
+  // a dead worker must not take the runner with it
+  IgnoredSignal sigpipe{SIGPIPE};
+  std::span<TestCase const> cases;
+  RunConfig config;
+  std::vector<Worker> workers;
+  std::vector<std::optional<Result>> results;
+  std::uint32_t next = 0;  // next case to dispatch
+
+  void spawn(Worker& worker) {
+    int tasks[2];
+    int reports[2];
+    if (pipe(tasks) != 0) {
+      throw std::runtime_error(std::string("pipe failed: ") + std::strerror(errno));
+    }
+    if (pipe(reports) != 0) {
+      auto error = errno;
+      close(tasks[0]);
+      close(tasks[1]);
+      throw std::runtime_error(std::string("pipe failed: ") + std::strerror(error));
+    }
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    auto pid = fork();
+    if (pid < 0) {
+      auto error = errno;
+      for (int fd : {tasks[0], tasks[1], reports[0], reports[1]}) {
+        close(fd);
+      }
+      throw std::runtime_error(std::string("fork failed: ") + std::strerror(error));
+    }
+
+    if (pid == 0) {
+      // tests see the disposition they would see without --isolate
+      sigpipe.restore();
+      // siblings must see EOF once the parent closes their pipes
+      for (auto const& other : workers) {
+        if (other.pid > 0) {
+          close(other.task_fd);
+          close(other.result_fd);
+        }
+      }
+      close(tasks[1]);
+      close(reports[0]);
+      worker_main(cases, tasks[0], reports[1], config);
+    }
+
+    close(tasks[0]);
+    close(reports[1]);
+    worker = {.pid = pid, .task_fd = tasks[1], .result_fd = reports[0]};
+  }
+
+  void reap(Worker& worker, bool timed_out = false) {
+    close(worker.task_fd);
+    close(worker.result_fd);
+    int status  = 0;
+    pid_t found = -1;
+    do {
+      found = waitpid(worker.pid, &status, 0);
+    } while (found < 0 && errno == EINTR);
+    auto const error = errno;
+    worker.pid       = -1;
+
+    if (!worker.current) {
+      return;
+    }
+
+    auto index       = *worker.current;
+    auto const& test = cases[index];
+    auto result      = Result{.test = test.test, .describe = test.describe, .args = test.args};
+    result.outcome   = TestOutcome(test.test->expect_failure);
+    if (timed_out) {
+      result.exception = std::format("test timed out after {} s", config.timeout);
+    } else if (found < 0) {
+      result.exception = std::format("test process could not be waited for: {}", strerror(error));
+    } else if (WIFSIGNALED(status)) {
+      auto signal = WTERMSIG(status);
+      result.exception =
+          std::format("test process terminated by signal {} ({})", signal, strsignal(signal));
+    } else {
+      result.exception = std::format("test process exited with status {}", WEXITSTATUS(status));
+    }
+    results[index] = std::move(result);
+    worker.current.reset();
+  }
+
+  [[nodiscard]] bool busy() const {
+    return std::ranges::any_of(workers, [](Worker const& worker) { return bool(worker.current); });
+  }
+
+  //? serial cases wait for every case in flight and keep the pool to themselves until done,
+  //? the same way the thread pool runs them
+  [[nodiscard]] bool exclusive() const {
+    return std::ranges::any_of(workers, [&](Worker const& worker) {
+      return worker.current && cases[*worker.current].test->serial;
+    });
+  }
+
+  void dispatch() {
+    for (auto& worker : workers) {
+      if (next >= cases.size() || exclusive()) {
+        return;
+      }
+      if (worker.current) {
+        continue;
+      }
+      if (cases[next].test->serial && busy()) {
+        return;
+      }
+      if (worker.pid < 0) {
+        spawn(worker);
+      }
+
+      if (!write_all(worker.task_fd, {reinterpret_cast<char const*>(&next), sizeof(next)})) {
+        // died while idle, it will be replaced on the next round
+        reap(worker);
+        continue;
+      }
+      worker.current = next++;
+      worker.started = std::chrono::steady_clock::now();
+    }
+  }
+
+  // milliseconds until the first case in flight runs out of time, -1 without a timeout
+  [[nodiscard]] int poll_timeout() const {
+    if (config.timeout == 0) {
+      return -1;
+    }
+    auto const now   = std::chrono::steady_clock::now();
+    auto const limit = std::chrono::seconds(config.timeout);
+    auto wait        = std::chrono::milliseconds(std::numeric_limits<int>::max());
+    for (auto const& worker : workers) {
+      if (worker.current) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(worker.started + limit - now);
+        wait           = std::clamp(remaining, std::chrono::milliseconds(0), wait);
+      }
+    }
+    return int(wait.count());
+  }
+
+  //? cpu_limit only catches cases burning CPU, a case blocked on a lock or a pipe is killed here
+  void expire() {
+    if (config.timeout == 0) {
+      return;
+    }
+    auto const now   = std::chrono::steady_clock::now();
+    auto const limit = std::chrono::seconds(config.timeout);
+    for (auto& worker : workers) {
+      if (worker.current && now - worker.started >= limit) {
+        kill(worker.pid, SIGKILL);
+        reap(worker, true);
+      }
+    }
+  }
+
+  void collect() {
+    std::vector<pollfd> fds;
+    std::vector<Worker*> polled;
+    for (auto& worker : workers) {
+      if (worker.current) {
+        fds.push_back({.fd = worker.result_fd, .events = POLLIN, .revents = 0});
+        polled.push_back(&worker);
+      }
+    }
+    if (fds.empty()) {
+      return;
+    }
+
+    if (poll(fds.data(), fds.size(), poll_timeout()) < 0) {
+      if (errno == EINTR) {
+        return;
+      }
+      throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+    }
+
+    std::string frame;
+    for (std::size_t idx = 0; idx < fds.size(); ++idx) {
+      if (fds[idx].revents == 0) {
+        continue;
+      }
+
+      auto& worker = *polled[idx];
+      if (!read_frame(worker.result_fd, frame)) {
+        // worker died mid-test
+        reap(worker);
+        continue;
+      }
+
+      auto in          = Reader(frame);
+      auto index       = in.read<std::uint32_t>();
+      auto const& test = cases[index];
+      auto result      = Result{.test = test.test, .describe = test.describe, .args = test.args};
+      deserialize(in, result);
+      results[index] = std::move(result);
+      worker.current.reset();
+    }
+    expire();
+  }
+
+public:
+  ProcessPoolExecutor(std::span<TestCase const> cases, std::size_t jobs, RunConfig const& config)
+      : cases(cases)
+      , config(config)
+      , workers(jobs)
+      , results(cases.size()) {
+    for (auto& worker : workers) {
+      spawn(worker);
+    }
+    dispatch();
+  }
+
+  ~ProcessPoolExecutor() override {
+    for (auto& worker : workers) {
+      if (worker.pid > 0) {
+        if (worker.current) {
+          // abandoned mid-case, e.g. a reporter threw. It might never finish on its own
+          kill(worker.pid, SIGKILL);
+          worker.current.reset();
+        }
+        reap(worker);
+      }
+    }
+  }
+
+  Result take(std::size_t index) override {
+    while (!results[index]) {
+      dispatch();
+      collect();
+    }
+    auto result = std::move(*results[index]);
+    results[index].reset();
+    return result;
+  }
+};
+}  // namespace
+
+std::unique_ptr<Executor> make_process_pool(RunConfig const& config,
+                                            std::span<TestCase const> cases,
+                                            std::size_t jobs) {
+  return std::make_unique<ProcessPoolExecutor>(cases, jobs, config);
+}
+}  // namespace rsl::testing::_testing_impl
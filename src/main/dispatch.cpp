@@ -0,0 +1,165 @@
+#include "dispatch.hpp"
+
+#include <utility>
+
+#ifndef _WIN32
+#  include <pthread.h>
+#endif
+
+namespace rsl::testing {
+namespace {
+//? worker processes are forked while reporters run. A child inheriting stdio or malloc locks
+//? held by the reporter thread deadlocks on its first print, so fork waits for the reporter
+//? thread to finish its batch and keeps it parked until the child exists
+std::mutex delivering;  // held by reporter threads whenever they are not idle
+
+void park_reporters_around_fork() {
+#ifndef _WIN32
+  static bool const registered = pthread_atfork([] { delivering.lock(); },
+                                                [] { delivering.unlock(); },
+                                                [] { delivering.unlock(); }) == 0;
+  (void)registered;
+#endif
+}
+}  // namespace
+
+AsyncReporter::~AsyncReporter() {
+  stop();
+}
+
+void AsyncReporter::add(std::unique_ptr<Reporter> reporter, Output& output) {
+  reporter->attach(output);
+  targets.push_back({std::move(reporter), &output});
+}
+
+void AsyncReporter::push(Event event) {
+  if (!async) {
+    deliver(event);
+    return;
+  }
+
+  if (!worker.joinable()) {
+    park_reporters_around_fork();
+    worker = std::thread(&AsyncReporter::drain, this);
+  }
+
+  {
+    auto lock = std::unique_lock(mutex);
+    space.wait(lock, [&] { return queue.size() < capacity; });
+    queue.push_back(std::move(event));
+  }
+  ready.notify_one();
+}
+
+void AsyncReporter::deliver(Event& event) {
+  struct Visitor {
+    Reporter& reporter;
+
+    void operator()(BeforeRun const& event) const { reporter.before_run(*event.tests); }
+    void operator()(AfterRun const&) const { reporter.after_run(); }
+    void operator()(BeforeTestGroup const& event) const { reporter.before_test_group(*event.test); }
+    void operator()(AfterTestGroup& event) const { reporter.after_test_group(event.results); }
+    void operator()(BeforeTest const& event) const { reporter.before_test(event.test); }
+    void operator()(AfterTest const& event) const { reporter.after_test(event.result); }
+    void operator()(EnterNamespace const& event) const { reporter.enter_namespace(event.name); }
+    void operator()(ExitNamespace const& event) const { reporter.exit_namespace(event.name); }
+  };
+
+  for (auto& target : targets) {
+    std::visit(Visitor{*target.reporter}, event);
+  }
+}
+
+void AsyncReporter::drain() {
+  auto busy = std::unique_lock(delivering);
+  std::deque<Event> batch;
+  while (true) {
+    // waiting for events takes neither stdio nor malloc locks, forking is fine meanwhile
+    busy.unlock();
+    bool done = false;
+    {
+      auto lock = std::unique_lock(mutex);
+      ready.wait(lock, [&] { return !queue.empty() || closed; });
+      done = queue.empty();
+      batch.swap(queue);
+    }
+    space.notify_all();
+    busy.lock();
+    if (done) {
+      return;
+    }
+
+    for (auto& event : batch) {
+      if (error) {
+        // keep draining so the test thread never blocks on a broken reporter
+        continue;
+      }
+      try {
+        deliver(event);
+      } catch (...) { error = std::current_exception(); }
+    }
+    batch.clear();
+  }
+}
+
+void AsyncReporter::stop() {
+  if (!worker.joinable()) {
+    return;
+  }
+  {
+    auto lock = std::lock_guard(mutex);
+    closed    = true;
+  }
+  ready.notify_one();
+  worker.join();
+}
+
+void AsyncReporter::before_run(TestNamespace const& tests) {
+  push(BeforeRun{&tests});
+}
+
+void AsyncReporter::after_run() {
+  push(AfterRun{});
+}
+
+void AsyncReporter::before_test_group(Test const& test) {
+  push(BeforeTestGroup{&test});
+}
+
+void AsyncReporter::after_test_group(std::span<Result> results) {
+  push(AfterTestGroup{{results.begin(), results.end()}});
+}
+
+void AsyncReporter::before_test(TestCase const& test) {
+  push(BeforeTest{test});
+}
+
+void AsyncReporter::after_test(Result const& result) {
+  push(AfterTest{result});
+}
+
+void AsyncReporter::list_tests(TestNamespace const& tests) {
+  for (auto& target : targets) {
+    target.reporter->list_tests(tests);
+  }
+}
+
+void AsyncReporter::enter_namespace(std::string_view name) {
+  push(EnterNamespace{name});
+}
+
+void AsyncReporter::exit_namespace(std::string_view name) {
+  push(ExitNamespace{name});
+}
+
+void AsyncReporter::finalize(Output&) {
+  stop();
+  if (error) {
+    std::rethrow_exception(std::exchange(error, nullptr));
+  }
+  for (auto& target : targets) {
+    target.reporter->finalize(*target.output);
+    target.output->flush();
+  }
+}
+}  // namespace rsl::testing
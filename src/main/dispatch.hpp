@@ -0,0 +1,102 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include <rsl/testing/output.hpp>
+#include <rsl/testing/result.hpp>
+#include <rsl/testing/test.hpp>
+
+namespace rsl::testing {
+//? forwards every event to several reporters. Unless disabled, events are copied into a
+//? queue and delivered by a dedicated thread so formatting and I/O never hold up the tests
+class AsyncReporter : public Reporter {
+  struct Target {
+    std::unique_ptr<Reporter> reporter;
+    Output* output;
+  };
+
+  struct BeforeRun {
+    TestNamespace const* tests;
+  };
+  struct AfterRun {};
+  struct BeforeTestGroup {
+    Test const* test;
+  };
+  struct AfterTestGroup {
+    std::vector<Result> results;
+  };
+  struct BeforeTest {
+    TestCase test;
+  };
+  struct AfterTest {
+    Result result;
+  };
+  struct EnterNamespace {
+    std::string_view name;
+  };
+  struct ExitNamespace {
+    std::string_view name;
+  };
+
+  using Event = std::variant<BeforeRun,
+                             AfterRun,
+                             BeforeTestGroup,
+                             AfterTestGroup,
+                             BeforeTest,
+                             AfterTest,
+                             EnterNamespace,
+                             ExitNamespace>;
+
+  // the test thread blocks once this many events are pending
+  static constexpr std::size_t capacity = 4096;
+
+  std::vector<Target> targets;
+  bool async;
+
+  std::mutex mutex;
+  std::condition_variable ready;  // events were queued or the queue was closed
+  std::condition_variable space;  // events were taken from the queue
+  std::deque<Event> queue;
+  bool closed = false;
+  std::exception_ptr error;  // first exception thrown by a reporter
+  std::thread worker;
+
+  void push(Event event);
+  void deliver(Event& event);
+  void drain();
+  void stop();
+
+public:
+  explicit AsyncReporter(bool async = true) : async(async) {}
+  ~AsyncReporter() override;
+
+  // must not be called once the run started
+  void add(std::unique_ptr<Reporter> reporter, Output& output);
+
+  void before_run(TestNamespace const& tests) override;
+  void after_run() override;
+
+  void before_test_group(Test const& test) override;
+  void after_test_group(std::span<Result> results) override;
+
+  void before_test(TestCase const& test) override;
+  void after_test(Result const& result) override;
+
+  void list_tests(TestNamespace const& tests) override;
+
+  void enter_namespace(std::string_view name) override;
+  void exit_namespace(std::string_view name) override;
+
+  // waits for all events to be delivered, `output` is unused, every reporter has its own
+  void finalize(Output& output) override;
+};
+}  // namespace rsl::testing
@@ -1,5 +1,8 @@
+#include <charconv>
+#include <cstdint>
 #include <memory>
 #include <ranges>
+#include <stdexcept>
 #include <string_view>
 #include <string>
 
@@ -8,6 +11,7 @@
 #include <rsl/testing/test.hpp>
 #include <rsl/testing/util.hpp>
 #include <rsl/testing/_testing_impl/factory.hpp>
+#include "dispatch.hpp"
 #include "output.hpp"
 
 std::string_view base_name(std::string_view name) {
@@ -45,6 +49,87 @@ std::vector<std::string_view> split_filter_path(std::string_view filter) {
   return parts;
 }
 
+std::vector<std::string_view> split_list(std::string_view list) {
+  std::vector<std::string_view> parts;
+  for (auto part : std::views::split(list, ',')) {
+    if (!part.empty()) {
+      parts.emplace_back(part.begin(), part.end());
+    }
+  }
+  return parts;
+}
+
+rsl::testing::ChangedLines parse_changed_lines(std::string_view spec) {
+  // path:first-last, path:line or just path
+  auto separator = spec.rfind(':');
+  if (separator == std::string_view::npos) {
+    return {std::string(spec)};
+  }
+
+  auto range = spec.substr(separator + 1);
+  auto dash  = range.find('-');
+
+  std::size_t first = 0;
+  std::size_t last  = 0;
+  auto first_part   = range.substr(0, dash);
+  auto parsed       = std::from_chars(first_part.begin(), first_part.end(), first);
+  if (parsed.ec != std::errc{} || parsed.ptr != first_part.end()) {
+    // not a line specification, might be a drive letter
+    return {std::string(spec)};
+  }
+  last = first;
+  if (dash != std::string_view::npos) {
+    auto last_part = range.substr(dash + 1);
+    parsed         = std::from_chars(last_part.begin(), last_part.end(), last);
+    if (parsed.ec != std::errc{} || parsed.ptr != last_part.end()) {
+      throw std::invalid_argument("invalid line range: " + std::string(spec));
+    }
+  }
+  return {std::string(spec.substr(0, separator)), first, last};
+}
+
+rsl::testing::AssertionTracking parse_assertion_tracking(std::string_view mode) {
+  using enum rsl::testing::AssertionTracking;
+  if (mode == "all") {
+    return all;
+  }
+  if (mode == "failures") {
+    return failures;
+  }
+  if (mode == "last") {
+    return last;
+  }
+  if (mode == "count") {
+    return count;
+  }
+  throw std::invalid_argument("invalid assertion tracking mode: " + std::string(mode));
+}
+
+struct ReporterSpec {
+  std::string name;
+  std::string file;  // empty for the default output
+};
+
+ReporterSpec parse_reporter(std::string_view spec) {
+  // name, name::file or Catch2 style name::out=file
+  auto separator = spec.find("::");
+  if (separator == std::string_view::npos) {
+    return {std::string(spec)};
+  }
+
+  auto result = ReporterSpec{std::string(spec.substr(0, separator))};
+  for (auto part : std::views::split(spec.substr(separator + 2), std::string_view("::"))) {
+    auto option = std::string_view(part.begin(), part.end());
+    if (option.starts_with("out=")) {
+      result.file = option.substr(4);
+    } else if (!option.contains('=')) {
+      result.file = option;
+    }
+    // other Catch2 reporter options such as colour-mode are not supported
+  }
+  return result;
+}
+
 void filter_test_tree(rsl::testing::TestRoot& root,
                       std::string_view filter,
                       std::vector<std::string> subfilters) {
@@ -68,25 +153,73 @@ class[[= rsl::cli::description("rsl::test (in Catch2 v3.8.1 compatibility mode)"
     : public rsl::cli {
   rsl::testing::TestRoot tree;
   std::vector<std::string> sections;
+  std::vector<rsl::testing::ChangedLines> changes;
+  std::vector<ReporterSpec> reporters;
   std::unique_ptr<rsl::testing::Output> _output;
 
 public:
-  [[= positional]] std::string filter    = "";
-  [[= option]] std::string reporter      = "plain";
-  [[= option]] bool durations            = true;
-  [[ = option, = flag ]] bool list_tests = false;
-  [[= option]] bool use_colour           = true;
+  [[= positional]] std::string filter               = "";
+  [[= option]] bool durations                       = true;
+  [[ = option, = flag ]] bool list_tests            = false;
+  [[= option]] bool use_colour                      = true;
+  [[ = option, = shorthand("j") ]] std::size_t jobs = 1;
+  [[ = option, = flag ]] bool isolate               = false;
+  [[= option]] std::size_t memory_limit             = 0;
+  [[= option]] std::size_t cpu_limit                = 0;
+  [[= option]] std::size_t timeout                  = 0;
+  [[= option]] bool capture                         = true;
+  [[= option]] bool capture_stderr                  = false;
+  [[ = option, = flag ]] bool perf_counters         = false;
+  [[= option]] std::string track_assertions         = "all";
+  [[= option]] std::size_t assertion_limit          = 64;
+  [[ = option, = flag ]] bool assertion_sites       = false;
+  [[= option]] std::size_t shard_index              = 0;
+  [[= option]] std::size_t shard_count              = 1;
+  [[= option]] std::string history                  = "";
+  [[= option]] std::size_t history_report           = 0;
+  [[= option]] std::string impact_index             = "";
+  [[ = option, = flag ]] bool benchmark             = false;
+  [[= option]] std::size_t benchmark_samples        = 10;
+  [[= option]] double benchmark_min_time            = 10;
+  [[ = option, = flag ]] bool fuzz                  = false;
+  [[= option]] std::size_t fuzz_runs                = 10'000;
+  [[= option]] double fuzz_time                     = 0;
+  [[= option]] std::size_t fuzz_max_len             = 4096;
+  [[= option]] std::uint64_t fuzz_seed              = 0;
+  [[= option]] std::string fuzz_corpus              = "";
+  [[ = option, = flag ]] bool fuzz_minimize         = false;
+  [[= option]] std::size_t fuzz_jobs                = 1;
+  [[= option]] bool async_reporters                 = true;
 
   [[ = option, = shorthand("c") ]] void section(std::string part) {
     sections.emplace_back(std::move(part));
   }
 
+  // name[::file], may be passed more than once. Reports without a file go to `output`
+  [[= option]] void reporter(std::string spec) {
+    reporters.push_back(parse_reporter(spec));
+  }
+
   [[= option]] void output(std::string filename) {
     _output = std::make_unique<rsl::testing::FileOutput>(filename);
   }
 
   [[= option]] void verbosity(std::string level) {}
 
+  // comma separated list of changed files
+  [[= option]] void changed_files(std::string files) {
+    for (auto file : split_list(files)) {
+      changes.push_back({std::string(file)});
+    }
+  }
+
+  // comma separated list of path:first-last
+  [[= option]] void changed_lines(std::string lines) {
+    for (auto spec : split_list(lines)) {
+      changes.push_back(parse_changed_lines(spec));
+    }
+  }
+
   explicit TestConfig()
       : tree(rsl::testing::get_tests())
       , _output(new rsl::testing::ConsoleOutput()) {}
@@ -105,26 +238,61 @@ public:
     for (auto const& test : current.tests) {
       std::println("{} - {}", current_indent, test.name);
       for (auto const& run : test.get_tests()) {
-        std::println("{} - {}", std::string((indent + 1) * 2, ' '), run.name);
+        std::println("{} - {}", std::string((indent + 1) * 2, ' '), run.name());
       }
     }
   }
 
   void run() {
-    std::unique_ptr<rsl::testing::Reporter> selected_reporter;
-    if (reporter.empty()) {
-      selected_reporter = rsl::testing::Reporter::make("plain");
-    } else {
-      selected_reporter = rsl::testing::Reporter::make(reporter);
+    if (reporters.empty()) {
+      reporters.push_back({"plain"});
+    }
+
+    std::vector<std::unique_ptr<rsl::testing::Output>> files;
+    auto selected_reporter = rsl::testing::AsyncReporter(async_reporters);
+    for (auto const& [name, file] : reporters) {
+      auto* target = _output.get();
+      if (!file.empty()) {
+        target = files.emplace_back(std::make_unique<rsl::testing::FileOutput>(file)).get();
+      }
+      selected_reporter.add(rsl::testing::Reporter::make(name), *target);
     }
 
     if (list_tests) {
       // tree.print(selected_reporter.get()); // TODO
-      selected_reporter->list_tests(tree);
+      selected_reporter.list_tests(tree);
     } else {
-      tree.run(selected_reporter.get());
+      tree.run(&selected_reporter,
+               {.jobs               = jobs,
+                .isolate            = isolate,
+                .memory_limit       = memory_limit,
+                .cpu_limit          = cpu_limit,
+                .timeout            = timeout,
+                .capture            = capture,
+                .capture_stderr     = capture_stderr,
+                .perf_counters      = perf_counters,
+                .shard_index        = shard_index,
+                .shard_count        = shard_count,
+                .history            = history,
+                .history_report     = history_report,
+                .impact_index       = impact_index,
+                .changes            = changes,
+                .assertion_tracking = parse_assertion_tracking(track_assertions),
+                .assertion_limit    = assertion_limit,
+                .assertion_sites    = assertion_sites,
+                .benchmark          = benchmark,
+                .benchmark_samples  = benchmark_samples,
+                .benchmark_min_time = benchmark_min_time,
+                .fuzz               = fuzz,
+                .fuzz_runs          = fuzz_runs,
+                .fuzz_time          = fuzz_time,
+                .fuzz_max_len       = fuzz_max_len,
+                .fuzz_seed          = fuzz_seed,
+                .fuzz_corpus        = fuzz_corpus,
+                .fuzz_minimize      = fuzz_minimize,
+                .fuzz_jobs          = fuzz_jobs});
     }
-    selected_reporter->finalize(*_output);
+    selected_reporter.finalize(*_output);
   }
 };
 
@@ -1,13 +1,215 @@
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <fstream>
+#include <mutex>
 #include <stdexcept>
 #include <cstdio>
+#include <string>
+#include <thread>
 #include <rsl/testing/output.hpp>
 
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <pthread.h>
+#  include <signal.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+#endif
+
 namespace rsl::testing {
+//? printing every line on its own costs more than running most test cases
+//? output is collected and written once the buffer fills up or has been held for too long
+//? a background thread enforces the delay, so a hanging test cannot hold back its
+//? `[ RUN      ]` line. Whatever is pending when the process crashes is written as well
+//? worker processes are forked while that thread runs, so it never touches stdio: a child
+//? inheriting the stdout lock from it would deadlock on its first print
 class ConsoleOutput : public Output {
+  static constexpr std::size_t capacity = 64 * 1024;
+  static constexpr auto max_delay       = std::chrono::milliseconds(100);
+
+  std::string buffer;
+  std::chrono::steady_clock::time_point last_write = std::chrono::steady_clock::now();
+#ifndef _WIN32
+  // a duplicate of stdout, tests capturing their output redirect the original
+  int fd = STDOUT_FILENO;
+#endif
+
+  std::mutex mutex;  // guards everything above
+  std::condition_variable wake;
+  bool stopping = false;
+  std::thread flusher;
+
+#ifndef _WIN32
+  static constexpr auto fatal_signals = std::array{SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+  static inline std::atomic<ConsoleOutput*> crash_target{nullptr};
+  static inline std::array<struct sigaction, fatal_signals.size()> previous{};
+
+  static void on_fatal_signal(int signal) {
+    // best effort, the crashing thread might be in the middle of printing
+    if (auto* self = crash_target.exchange(nullptr); self != nullptr) {
+      std::size_t done = 0;
+      while (done < self->buffer.size()) {
+        auto written = ::write(self->fd, self->buffer.data() + done, self->buffer.size() - done);
+        if (written <= 0) {
+          break;
+        }
+        done += std::size_t(written);
+      }
+    }
+
+    // hand the signal to whoever was installed before, it is delivered once this returns
+    for (std::size_t idx = 0; idx < fatal_signals.size(); ++idx) {
+      if (fatal_signals[idx] == signal) {
+        sigaction(signal, &previous[idx], nullptr);
+      }
+    }
+    raise(signal);
+  }
+
+  void install_crash_handler() {
+    // forked workers inherit the buffer, it must only be written by this process
+    static bool const registered = pthread_atfork(nullptr, nullptr, [] {
+      crash_target = nullptr;
+    }) == 0;
+    (void)registered;
+
+    crash_target = this;
+    struct sigaction action{};
+    action.sa_handler = on_fatal_signal;
+    sigemptyset(&action.sa_mask);
+    for (std::size_t idx = 0; idx < fatal_signals.size(); ++idx) {
+      sigaction(fatal_signals[idx], &action, &previous[idx]);
+    }
+  }
+
+  void remove_crash_handler() {
+    auto* self = this;
+    if (crash_target.compare_exchange_strong(self, nullptr)) {
+      for (std::size_t idx = 0; idx < fatal_signals.size(); ++idx) {
+        sigaction(fatal_signals[idx], &previous[idx], nullptr);
+      }
+    }
+  }
+#endif
+
+  // runs on `flusher` until destruction
+  void flush_periodically() {
+    auto lock = std::unique_lock(mutex);
+    while (!stopping) {
+      if (buffer.empty()) {
+        wake.wait(lock);
+        continue;
+      }
+      wake.wait_until(lock, last_write + max_delay);
+      if (!buffer.empty() && std::chrono::steady_clock::now() - last_write >= max_delay) {
+        write({}, false);
+      }
+    }
+  }
+
+  // writes the buffer followed by `extra` with a single system call if possible
+  // callers hold `mutex`. `sync_stdio` keeps the order with anything printed through stdio
+  void write(std::string_view extra = {}, bool sync_stdio = true) {
+    if (sync_stdio) {
+      (void)std::fflush(stdout);
+    }
+#ifdef _WIN32
+    (void)std::fwrite(buffer.data(), sizeof(char), buffer.size(), stdout);
+    (void)std::fwrite(extra.data(), sizeof(char), extra.size(), stdout);
+    (void)std::fflush(stdout);
+#else
+    auto parts = std::array{iovec{buffer.data(), buffer.size()},
+                            iovec{const_cast<char*>(extra.data()), extra.size()}};
+    std::size_t first = 0;
+    while (first < parts.size()) {
+      auto written = ::writev(fd, parts.data() + first, int(parts.size() - first));
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        // nothing sensible left to do if the console went away
+        break;
+      }
+
+      auto remaining = std::size_t(written);
+      while (first < parts.size() && remaining >= parts[first].iov_len) {
+        remaining -= parts[first].iov_len;
+        ++first;
+      }
+      if (first < parts.size()) {
+        parts[first].iov_base = static_cast<char*>(parts[first].iov_base) + remaining;
+        parts[first].iov_len -= remaining;
+      }
+    }
+#endif
+    buffer.clear();
+    last_write = std::chrono::steady_clock::now();
+  }
+
 public:
+  ConsoleOutput() {
+    buffer.reserve(capacity);
+#ifndef _WIN32
+    if (auto copy = ::dup(STDOUT_FILENO); copy >= 0) {
+      fd = copy;
+    }
+    install_crash_handler();
+#endif
+    flusher = std::thread(&ConsoleOutput::flush_periodically, this);
+  }
+  ConsoleOutput(ConsoleOutput const&)            = delete;
+  ConsoleOutput& operator=(ConsoleOutput const&) = delete;
+  ~ConsoleOutput() override {
+    {
+      auto lock = std::lock_guard(mutex);
+      stopping  = true;
+    }
+    wake.notify_one();
+    flusher.join();
+    flush();
+#ifndef _WIN32
+    remove_crash_handler();
+    if (fd != STDOUT_FILENO) {
+      ::close(fd);
+    }
+#endif
+  }
+
   void print(std::string_view message) override {
-    (void)std::fwrite(message.data(), sizeof(char), message.size(), stdout);
+    auto lock = std::lock_guard(mutex);
+    if (buffer.size() + message.size() > capacity) {
+      // large messages are written straight from the caller's memory
+      write(message);
+      return;
+    }
+    bool const idle = buffer.empty();
+    buffer += message;
+    if (std::chrono::steady_clock::now() - last_write >= max_delay) {
+      write();
+    } else if (idle) {
+      // the flusher only keeps time while something is pending
+      wake.notify_one();
+    }
+  }
+
+  void flush() override {
+    auto lock = std::lock_guard(mutex);
+    if (!buffer.empty()) {
+      write();
+    }
+  }
+
+  [[nodiscard]] bool is_terminal() const override {
+#ifdef _WIN32
+    return _isatty(_fileno(stdout)) != 0;
+#else
+    return isatty(fd) != 0;
+#endif
   }
 };
 
@@ -21,6 +223,7 @@ public:
   }
 
   void print(std::string_view message) override { file_ << message; }
+  void flush() override { file_.flush(); }
 
   ~FileOutput() override {
     if (file_.is_open()) {
@@ -32,4 +235,4 @@ public:
 private:
   std::ofstream file_;
 };
-}  // namespace rsl::testing
\ No newline at end of file
+}  // namespace rsl::testing
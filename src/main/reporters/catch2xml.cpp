@@ -1,233 +1,211 @@
-#include <numeric>
+#include <optional>
 #include <print>
+#include <ranges>
 #include <string>
-#include <optional>
+#include <string_view>
 #include <vector>
 
 #include <rsl/testing/output.hpp>
 #include <rsl/xml>
 
+#include "xml_writer.hpp"
+
 namespace rsl::testing::_xml_impl {
 struct OverallResult {
-  [[= xml::attribute]] bool success             = true;
-  [[= xml::attribute]] unsigned skips           = 0;
-  [[= xml::attribute]] double durationInSeconds = 0.0;
+  bool success             = true;
+  unsigned skips           = 0;
+  double durationInSeconds = 0.0;
 };
 
 struct OverallResults {
-  [[= xml::attribute]] unsigned successes        = 0;
-  [[= xml::attribute]] unsigned failures         = 0;
-  [[= xml::attribute]] unsigned expectedFailures = 0;
-  [[= xml::attribute]] bool skipped              = false;
-  [[= xml::attribute]] double durationInSeconds  = 0.0;
+  unsigned successes        = 0;
+  unsigned failures         = 0;
+  unsigned expectedFailures = 0;
+  bool skipped              = false;
+  double durationInSeconds  = 0.0;
 };
 
 struct OverallResultsCases {
-  [[= xml::attribute]] unsigned successes        = 0;
-  [[= xml::attribute]] unsigned failures         = 0;
-  [[= xml::attribute]] unsigned expectedFailures = 0;
-  [[= xml::attribute]] unsigned skips            = 0;
+  unsigned successes        = 0;
+  unsigned failures         = 0;
+  unsigned expectedFailures = 0;
+  unsigned skips            = 0;
 };
 
-struct StdOut {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::raw]] std::string value;
-};
-struct StdErr {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::raw]] std::string value;
-};
-struct Exception {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::raw]] std::string value;
-};
-struct FatalErrorCondition {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::raw]] std::string value;
-};
-struct Failure {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::raw]] std::string value;
-};
-struct Warning {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::raw]] std::string value;
-};
-struct Info {
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
+struct Name {
   [[= xml::raw]] std::string value;
 };
 
-struct Section {
-  [[= xml::attribute]] std::string name;
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-  [[= xml::node]] std::vector<Section> sections;
-  [[= xml::node]] OverallResults results;
-
-  [[= xml::node]] std::optional<StdOut> stdout;
-  [[= xml::node]] std::optional<StdErr> stderr;
-  [[= xml::node]] std::optional<Exception> exception;
-  [[= xml::node]] std::optional<FatalErrorCondition> fatal_ec;
-  [[= xml::node]] std::optional<Failure> failure;
-  [[= xml::node]] std::optional<Warning> warning;
-  [[= xml::node]] std::optional<Info> info;
-
-  void update_results() {
-    for (auto& section : sections) {
-      section.update_results();
-      results.successes += section.results.successes;
-      results.failures += section.results.failures;
-      results.expectedFailures += section.results.expectedFailures;
-      results.durationInSeconds += section.results.durationInSeconds;
-    }
-  }
+struct MatchingTests {
+  struct TestCase {
+    Name name;
+  };
+  [[= xml::node]] std::vector<MatchingTests::TestCase> tests;
 };
 
-struct TestCase {
-  [[= xml::attribute]] std::string name;
-  [[= xml::attribute]] std::optional<std::string> filename;
-  [[= xml::attribute]] std::optional<unsigned> line;
-
-  [[= xml::node]] std::vector<Section> sections;
-  [[= xml::node]] OverallResult result;
-
-  void update_results() {
-    for (auto& section : sections) {
-      section.update_results();
-
-      // TODO this is no good, we need to count skips in sections
-      result.skips += unsigned(section.results.skipped);
-    }
-    result.success = std::ranges::none_of(sections, [](Section const& section) {
-      return section.results.failures > section.results.expectedFailures;
-    });
+//? results arrive in tree order, so results sharing a top level name are contiguous
+//? every TestCase is written out and forgotten as soon as the next one starts
+class[[= rename("xml")]] Catch2XmlReporter : public Reporter::Registrar<Catch2XmlReporter> {
+  std::optional<XmlWriter> xml;
+
+  std::optional<std::string_view> current;  // top level name of the open TestCase
+  OverallResult case_result;
+  OverallResults test_results;
+  OverallResultsCases case_results;
+
+  void write_results(OverallResults const& results) {
+    xml->start("OverallResults")
+        .attribute("successes", results.successes)
+        .attribute("failures", results.failures)
+        .attribute("expectedFailures", results.expectedFailures)
+        .attribute("skipped", results.skipped)
+        .attribute("durationInSeconds", results.durationInSeconds)
+        .end();
   }
-};
 
-struct Catch2TestRun {
-  [[= xml::attribute]] std::optional<std::string> name;
-  [[= xml::attribute]] std::optional<std::size_t> rng_seed;
-  [[= xml::attribute]] std::size_t xml_format_version = 3;
-  [[= xml::attribute]] std::string catch2_version     = "3.8.1";
-
-  [[= xml::node]] std::vector<TestCase> tests;
-  [[= xml::node]] OverallResults test_results;
-  [[= xml::node]] OverallResultsCases case_results;
+  void open_case(std::string_view name) {
+    xml->start("TestCase").attribute("name", name);
+    current     = name;
+    case_result = {};
+  }
 
-  TestCase& get_tc(std::string_view name) {
-    for (auto& test : tests) {
-      if (test.name == name) {
-        return test;
-      }
+  void close_case() {
+    if (!current) {
+      return;
+    }
+    xml->start("OverallResult")
+        .attribute("success", case_result.success)
+        .attribute("skips", case_result.skips)
+        .attribute("durationInSeconds", case_result.durationInSeconds)
+        .end();
+    xml->end();
+
+    if (case_result.success) {
+      ++test_results.successes;
+    } else {
+      ++test_results.failures;
     }
-    tests.emplace_back(std::string(name));
-    return tests.back();
+    test_results.durationInSeconds += case_result.durationInSeconds;
+    current.reset();
   }
 
-  void update_results() {
-    test_results = {};
-    case_results = {};
-    for (TestCase& test : tests) {
-      test.update_results();
-      if (test.result.success) {
-        ++test_results.successes;
-      } else {
-        ++test_results.failures;
-      }
-      test_results.durationInSeconds += test.result.durationInSeconds;
+public:
+  void attach(Output& output) override { xml.emplace(output); }
 
-      for (Section const& section : test.sections) {
-        case_results.successes += section.results.successes;
-        case_results.failures += section.results.failures;
-        case_results.expectedFailures += section.results.expectedFailures;
-        // TODO count skips
-      }
+  void before_run(TestNamespace const& tests) override {
+    if (!xml) {
+      return;
     }
+    xml->start("Catch2TestRun")
+        .attribute("xml-format-version", 3)
+        .attribute("catch2-version", "3.8.1");
+    xml->flush();
   }
-};
 
-struct Name {
-  [[= xml::raw]] std::string value;
-};
-
-struct MatchingTests {
-  struct TestCase {
-    Name name;
-  };
-  [[= xml::node]] std::vector<MatchingTests::TestCase> tests;
-};
-
-class[[= rename("xml")]] Catch2XmlReporter : public Reporter::Registrar<Catch2XmlReporter> {
-  Catch2TestRun report;
-
-public:
   void before_test(rsl::testing::TestCase const& run) override {}
   void after_test(Result const& result) override {
-    TestCase& tc     = report.get_tc(result.test->full_name[0]);
-    Section* section = nullptr;
+    if (!xml) {
+      return;
+    }
+
+    auto const& full_name = result.test->full_name;
+    if (current != std::string_view(full_name[0])) {
+      close_case();
+      open_case(full_name[0]);
+    }
 
-    if (result.test->full_name.size() >= 2) {
-      section = &tc.sections.emplace_back(result.test->full_name[1]);
-      for (auto const& part : result.test->full_name | std::views::drop(2)) {
-        section = &section->sections.emplace_back(part);
+    // one section per enclosing namespace and the test itself, then one for the case
+    for (auto const& part : full_name | std::views::drop(1)) {
+      xml->start("Section").attribute("name", part);
+    }
+    xml->start("Section")
+        .attribute("name", result.name())
+        .attribute("filename", result.test->sloc.file_name())
+        .attribute("line", result.test->sloc.line());
+    if (result.allocations) {
+      // not part of the Catch2 format, readers ignore unknown attributes
+      xml->attribute("allocations", result.allocations->count)
+          .attribute("allocatedBytes", result.allocations->bytes)
+          .attribute("peakHeapBytes", result.allocations->peak);
+    }
+    if (auto const& counters = result.counters) {
+      xml->attribute("userMs", counters->user_ms).attribute("systemMs", counters->system_ms);
+      if (counters->cycles) {
+        xml->attribute("cycles", *counters->cycles);
+      }
+      if (counters->instructions) {
+        xml->attribute("instructions", *counters->instructions);
+      }
+      if (counters->cache_misses) {
+        xml->attribute("cacheMisses", *counters->cache_misses);
+      }
+      if (counters->branch_misses) {
+        xml->attribute("branchMisses", *counters->branch_misses);
       }
-      section->sections.emplace_back(result.name,
-                                     result.test->sloc.file_name(),
-                                     result.test->sloc.line());
-      section = &section->sections.back();
-    } else {
-      tc.sections.emplace_back(result.name,
-                               result.test->sloc.file_name(),
-                               result.test->sloc.line());
-      section = &tc.sections.back();
     }
 
     if (!result.stdout.empty()) {
-      section->stdout = {.value = result.stdout};
+      xml->element("StdOut", result.stdout);
     }
-
     if (!result.stderr.empty()) {
-      section->stderr = {.value = result.stderr};
+      xml->element("StdErr", result.stderr);
     }
 
+    OverallResults results{.durationInSeconds = result.duration_ms / 1000.};
     switch (result.outcome) {
       using enum TestOutcome;
-      case PASS: ++section->results.successes; break;
+      case PASS: ++results.successes; break;
       case FAIL:
-        if (result.failure.has_value()) {
-          section->failure = Failure{.filename = std::string(result.failure->sloc.file),
-                                     .line     = result.failure->sloc.line,
-                                     .value    = result.failure->message};
+        for (auto const& failure : result.failures) {
+          xml->start("Failure")
+              .attribute("filename", failure.sloc.file)
+              .attribute("line", failure.sloc.line)
+              .text(failure.message())
+              .end();
+        }
+        if (!result.exception.empty()) {
+          xml->start("Exception")
+              .attribute("filename", result.test->sloc.file_name())
+              .attribute("line", result.test->sloc.line())
+              .text(result.exception)
+              .end();
         }
-        ++section->results.failures;
+        ++results.failures;
+        case_result.success = false;
         break;
       case SKIP:
-        section->results.skipped = true;
-        ++tc.result.skips;
+        results.skipped = true;
+        ++case_result.skips;
+        ++case_results.skips;
         break;
     }
-    section->results.durationInSeconds += result.duration_ms / 1000.;
-
-    // <Expression success="false" type="REQUIRE"
-    // filename="/home/che/src/scratchpad/catch_test/src/test.cpp" line="16">
-    //   <Original>
-    //     x == false
-    //   </Original>
-    //   <Expanded>
-    //     false == false
-    //   </Expanded>
-    // </Expression>
+    case_results.successes += results.successes;
+    case_results.failures += results.failures;
+    case_result.durationInSeconds += results.durationInSeconds;
+
+    // enclosing sections only contain this case, so they share its results
+    for (std::size_t idx = 0; idx < full_name.size(); ++idx) {
+      write_results(results);
+      xml->end();
+    }
+    xml->flush();
   }
 
-  void after_run() override { report.update_results(); }
+  void after_run() override {
+    if (!xml) {
+      return;
+    }
+    close_case();
+    write_results(test_results);
+    xml->start("OverallResultsCases")
+        .attribute("successes", case_results.successes)
+        .attribute("failures", case_results.failures)
+        .attribute("expectedFailures", case_results.expectedFailures)
+        .attribute("skips", case_results.skips)
+        .end();
+    xml->end();
+    xml->flush();
+  }
 
   void list_tests(TestNamespace const& tests) override {
     MatchingTests matching{};
@@ -241,12 +219,5 @@ public:
     // todo use Output instead
     std::println("{}", rsl::to_xml(matching));
   }
-
-  void finalize(Output& target) override {
-    if (!report.tests.empty()) {
-      target.print(rsl::to_xml(std::move(report)));
-      report = {};
-    }
-  }
 };
-}  // namespace rsl::testing::_xml_impl
\ No newline at end of file
+}  // namespace rsl::testing::_xml_impl
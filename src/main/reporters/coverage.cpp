@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rsl/testing/output.hpp>
+#include <rsl/testing/result.hpp>
+
+namespace rsl::testing::_impl {
+namespace {
+//? the runner merges coverage as results are taken, reporters only see the merged table
+std::size_t lines_hit(FileCoverage const& file) {
+  return std::size_t(std::ranges::count_if(file.coverage, [](auto const& line) {
+    return line.count != 0;
+  }));
+}
+
+std::string escape(std::string_view text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char chr : text) {
+    switch (chr) {
+      case '&': escaped += "&amp;"; break;
+      case '<': escaped += "&lt;"; break;
+      case '>': escaped += "&gt;"; break;
+      case '"': escaped += "&quot;"; break;
+      default: escaped += chr;
+    }
+  }
+  return escaped;
+}
+
+void write_lcov(Output& out, std::span<FileCoverage const> files) {
+  for (auto const& file : files) {
+    out.printf("TN:\nSF:{}\n", file.filename);
+    for (auto const& [line, count] : file.coverage) {
+      out.printf("DA:{},{}\n", line, count);
+    }
+    out.printf("LF:{}\nLH:{}\nend_of_record\n", file.coverage.size(), lines_hit(file));
+  }
+}
+
+void write_cobertura(Output& out, std::span<FileCoverage const> files) {
+  auto rate = [](std::size_t hit, std::size_t found) {
+    return found == 0 ? 1.0 : double(hit) / double(found);
+  };
+
+  std::size_t total_found = 0;
+  std::size_t total_hit   = 0;
+  for (auto const& file : files) {
+    total_found += file.coverage.size();
+    total_hit += lines_hit(file);
+  }
+
+  auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  out.print("<?xml version=\"1.0\" ?>\n");
+  out.print(
+      "<!DOCTYPE coverage SYSTEM \"http://cobertura.sourceforge.net/xml/coverage-04.dtd\">\n");
+  out.printf(
+      "<coverage line-rate=\"{:.4f}\" branch-rate=\"0\" lines-covered=\"{}\" lines-valid=\"{}\" "
+      "branches-covered=\"0\" branches-valid=\"0\" complexity=\"0\" version=\"0.1\" "
+      "timestamp=\"{}\">\n",
+      rate(total_hit, total_found),
+      total_hit,
+      total_found,
+      timestamp);
+  out.print("  <sources><source>.</source></sources>\n  <packages>\n");
+  out.printf("    <package name=\"\" line-rate=\"{:.4f}\" branch-rate=\"0\" complexity=\"0\">\n",
+             rate(total_hit, total_found));
+  out.print("      <classes>\n");
+  for (auto const& file : files) {
+    auto escaped = escape(file.filename);
+    out.printf(
+        "        <class name=\"{0}\" filename=\"{0}\" line-rate=\"{1:.4f}\" branch-rate=\"0\" "
+        "complexity=\"0\">\n",
+        escaped,
+        rate(lines_hit(file), file.coverage.size()));
+    out.print("          <methods/>\n          <lines>\n");
+    for (auto const& [line, count] : file.coverage) {
+      out.printf("            <line number=\"{}\" hits=\"{}\"/>\n", line, count);
+    }
+    out.print("          </lines>\n        </class>\n");
+  }
+  out.print("      </classes>\n    </package>\n  </packages>\n</coverage>\n");
+}
+}  // namespace
+
+class[[= rename("lcov")]] LcovReporter : public Reporter::Registrar<LcovReporter> {
+public:
+  void before_test(TestCase const& test) override {}
+  void after_test(Result const& result) override {}
+  void finalize(Output& target) override { write_lcov(target, run_coverage()); }
+};
+
+class[[= rename("cobertura")]] CoberturaReporter : public Reporter::Registrar<CoberturaReporter> {
+public:
+  void before_test(TestCase const& test) override {}
+  void after_test(Result const& result) override {}
+  void finalize(Output& target) override { write_cobertura(target, run_coverage()); }
+};
+}  // namespace rsl::testing::_impl
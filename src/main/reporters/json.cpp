@@ -1,18 +1,428 @@
+#include <cmath>
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <rsl/testing/output.hpp>
-#include <print>
 #include <rsl/testing/assert.hpp>
+#include <rsl/testing/util.hpp>
 #include "rsl/testing/result.hpp"
 
 namespace rsl::testing::_impl {
+//? builds JSON text piecewise, containers may stay open across calls
+class JsonWriter {
+  std::string buffer;
+  std::vector<bool> empty;  // per open container: nothing was written to it yet
+  bool after_key = false;
+
+  void separator() {
+    if (after_key) {
+      after_key = false;
+      return;
+    }
+    if (!empty.empty()) {
+      if (!empty.back()) {
+        buffer += ',';
+      }
+      empty.back() = false;
+    }
+  }
+
+  void string(std::string_view text) {
+    buffer += '"';
+    for (char chr : text) {
+      switch (chr) {
+        case '"': buffer += "\\\""; break;
+        case '\\': buffer += "\\\\"; break;
+        case '\n': buffer += "\\n"; break;
+        case '\r': buffer += "\\r"; break;
+        case '\t': buffer += "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(chr) < 0x20) {
+            buffer += std::format("\\u{:04x}", static_cast<unsigned char>(chr));
+          } else {
+            buffer += chr;
+          }
+      }
+    }
+    buffer += '"';
+  }
+
+public:
+  JsonWriter& begin_object() {
+    separator();
+    buffer += '{';
+    empty.push_back(true);
+    return *this;
+  }
+
+  JsonWriter& end_object() {
+    buffer += '}';
+    empty.pop_back();
+    return *this;
+  }
+
+  JsonWriter& begin_array() {
+    separator();
+    buffer += '[';
+    empty.push_back(true);
+    return *this;
+  }
+
+  JsonWriter& end_array() {
+    buffer += ']';
+    empty.pop_back();
+    return *this;
+  }
+
+  JsonWriter& key(std::string_view name) {
+    separator();
+    string(name);
+    buffer += ':';
+    after_key = true;
+    return *this;
+  }
+
+  template <typename T>
+  JsonWriter& value(T const& value) {
+    separator();
+    if constexpr (std::is_same_v<T, bool>) {
+      buffer += value ? "true" : "false";
+    } else if constexpr (std::is_floating_point_v<T>) {
+      // JSON has no representation for inf and nan
+      buffer += std::isfinite(value) ? std::format("{}", value) : "null";
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      buffer += std::format("{}", value);
+    } else {
+      string(value);
+    }
+    return *this;
+  }
+
+  template <typename T>
+  JsonWriter& field(std::string_view name, T const& value) {
+    return key(name).value(value);
+  }
+
+  // everything written since the last call
+  std::string take() { return std::exchange(buffer, {}); }
+};
+
+std::string_view outcome_name(TestOutcome outcome) {
+  switch (outcome) {
+    using enum TestOutcome;
+    case PASS: return "passed";
+    case FAIL: return "failed";
+    case SKIP: return "skipped";
+  }
+  return "unknown";
+}
+
+void write_result(JsonWriter& json, Result const& result) {
+  json.begin_object()
+      .field("name", result.name())
+      .field("test", join_str(result.test->full_name, "::"))
+      .field("file", result.test->sloc.file_name())
+      .field("line", result.test->sloc.line())
+      .field("outcome", outcome_name(result.outcome))
+      .field("duration_ms", result.duration_ms);
+
+  if (!result.failures.empty()) {
+    json.key("failures").begin_array();
+    for (auto const& failure : result.failures) {
+      json.begin_object()
+          .field("message", failure.message())
+          .field("file", failure.sloc.file)
+          .field("line", failure.sloc.line)
+          .end_object();
+    }
+    json.end_array();
+  }
+  if (!result.exception.empty()) {
+    json.field("exception", result.exception);
+  }
+  if (!result.stdout.empty()) {
+    json.field("stdout", result.stdout);
+  }
+  if (!result.stderr.empty()) {
+    json.field("stderr", result.stderr);
+  }
+
+  json.field("assertions_passed", result.assertions_passed)
+      .field("assertions_failed", result.assertions_failed);
+  json.key("assertions").begin_array();
+  for (auto const& assertion : result.assertions) {
+    json.begin_object()
+        .field("expression", assertion.raw)
+        .field("expanded", assertion.expanded)
+        .field("success", assertion.success)
+        .end_object();
+  }
+  json.end_array();
+
+  if (result.benchmark) {
+    auto const& benchmark = *result.benchmark;
+    json.key("benchmark")
+        .begin_object()
+        .field("iterations", benchmark.iterations)
+        .field("samples", benchmark.samples)
+        .field("min_ns", benchmark.min_ns)
+        .field("median_ns", benchmark.median_ns)
+        .field("mean_ns", benchmark.mean_ns)
+        .field("stddev_ns", benchmark.stddev_ns)
+        .end_object();
+  }
+
+  if (result.allocations) {
+    json.key("allocations")
+        .begin_object()
+        .field("count", result.allocations->count)
+        .field("bytes", result.allocations->bytes)
+        .field("peak", result.allocations->peak)
+        .end_object();
+  }
+
+  if (result.counters) {
+    auto const& counters = *result.counters;
+    json.key("counters")
+        .begin_object()
+        .field("user_ms", counters.user_ms)
+        .field("system_ms", counters.system_ms)
+        .field("minor_faults", counters.minor_faults)
+        .field("major_faults", counters.major_faults)
+        .field("voluntary_switches", counters.voluntary_switches)
+        .field("involuntary_switches", counters.involuntary_switches);
+    if (counters.cycles) {
+      json.field("cycles", *counters.cycles);
+    }
+    if (counters.instructions) {
+      json.field("instructions", *counters.instructions);
+    }
+    if (counters.cache_misses) {
+      json.field("cache_misses", *counters.cache_misses);
+    }
+    if (counters.branch_misses) {
+      json.field("branch_misses", *counters.branch_misses);
+    }
+    json.end_object();
+  }
+
+  if (result.fuzz) {
+    auto const& fuzz = *result.fuzz;
+    json.key("fuzz")
+        .begin_object()
+        .field("runs", fuzz.runs)
+        .field("corpus_size", fuzz.corpus_size)
+        .field("features", fuzz.features)
+        .field("seed", fuzz.seed)
+        .field("duration_ms", fuzz.duration_ms)
+        .field("execs_per_second", fuzz.execs_per_second());
+    if (!fuzz.crash.empty()) {
+      std::string hex;
+      for (auto byte : fuzz.crash) {
+        hex += std::format("{:02x}", byte);
+      }
+      json.field("crash", hex);
+    }
+    if (!fuzz.crash_arguments.empty()) {
+      json.field("crash_arguments", fuzz.crash_arguments);
+    }
+    if (!fuzz.crash_file.empty()) {
+      json.field("crash_file", fuzz.crash_file);
+    }
+    json.end_object();
+  }
+  json.end_object();
+}
+
+// pass and fail counts per ASSERT, only present if the run counted them
+void write_assertion_sites(JsonWriter& json) {
+  auto const* site = _testing_impl::assertion_sites();
+  if (site == nullptr) {
+    return;
+  }
+  json.key("assertion_sites").begin_array();
+  for (; site != nullptr; site = site->next) {
+    json.begin_object()
+        .field("expression", site->expression)
+        .field("file", site->file)
+        .field("line", site->line)
+        .field("passed", site->passed.load(std::memory_order_relaxed))
+        .field("failed", site->failed.load(std::memory_order_relaxed))
+        .end_object();
+  }
+  json.end_array();
+}
+
+struct Summary {
+  std::size_t passed  = 0;
+  std::size_t failed  = 0;
+  std::size_t skipped = 0;
+  double duration_ms  = 0;
+
+  void add(Result const& result) {
+    switch (result.outcome) {
+      using enum TestOutcome;
+      case PASS: ++passed; break;
+      case FAIL: ++failed; break;
+      case SKIP: ++skipped; break;
+    }
+    duration_ms += result.duration_ms;
+  }
+
+  void write(JsonWriter& json) const {
+    json.begin_object()
+        .field("passed", passed)
+        .field("failed", failed)
+        .field("skipped", skipped)
+        .field("duration_ms", duration_ms)
+        .end_object();
+  }
+};
+
+// a single JSON document, written incrementally with the summary at the end
 class[[= rename("json")]] JsonReporter : public Reporter::Registrar<JsonReporter> {
+  Output* output = nullptr;
+  JsonWriter json;
+  Summary summary;
+
 public:
-  void before_run(TestNamespace const& tests) override {}
-  void enter_namespace(std::string_view name) override {}
-  void before_test_group(Test const& test) override {}
+  void attach(Output& target) override { output = &target; }
+
+  void before_run(TestNamespace const& tests) override {
+    if (output == nullptr) {
+      return;
+    }
+    json.begin_object().key("results").begin_array();
+    output->print(json.take());
+  }
+
   void before_test(TestCase const& test) override {}
-  void after_test(Result const& result) override {}
-  void after_test_group(std::span<Result> results) override {}
-  void exit_namespace(std::string_view name) override {}
-  void after_run() override {}
+  void after_test(Result const& result) override {
+    if (output == nullptr) {
+      return;
+    }
+    summary.add(result);
+    write_result(json, result);
+    output->print(json.take());
+  }
+
+  void after_run() override {
+    if (output == nullptr) {
+      return;
+    }
+    json.end_array().key("summary");
+    summary.write(json);
+    write_assertion_sites(json);
+    json.end_object();
+    output->print(json.take() + "\n");
+    output->flush();
+  }
+};
+
+// one JSON object per line and event, flushed immediately so consumers can follow the run
+class[[= rename("ndjson")]] NdjsonReporter : public Reporter::Registrar<NdjsonReporter> {
+  Output* output = nullptr;
+  JsonWriter json;
+  Summary summary;
+
+  JsonWriter& begin_event(std::string_view name) {
+    return json.begin_object().field("event", name);
+  }
+
+  void end_event() {
+    json.end_object();
+    output->print(json.take() + "\n");
+    output->flush();
+  }
+
+public:
+  void attach(Output& target) override { output = &target; }
+
+  void before_run(TestNamespace const& tests) override {
+    if (output == nullptr) {
+      return;
+    }
+    begin_event("before_run").field("tests", tests.count());
+    end_event();
+  }
+
+  void enter_namespace(std::string_view name) override {
+    if (output == nullptr) {
+      return;
+    }
+    begin_event("enter_namespace").field("name", name);
+    end_event();
+  }
+
+  void before_test_group(Test const& test) override {
+    if (output == nullptr) {
+      return;
+    }
+    begin_event("before_test_group")
+        .field("test", join_str(test.full_name, "::"))
+        .field("file", test.sloc.file_name())
+        .field("line", test.sloc.line());
+    end_event();
+  }
+
+  void before_test(TestCase const& test) override {
+    if (output == nullptr) {
+      return;
+    }
+    begin_event("before_test").field("name", test.name());
+    end_event();
+  }
+
+  void after_test(Result const& result) override {
+    if (output == nullptr) {
+      return;
+    }
+    summary.add(result);
+    begin_event("after_test").key("result");
+    write_result(json, result);
+    end_event();
+  }
+
+  void after_test_group(std::span<Result> results) override {
+    if (output == nullptr || results.empty()) {
+      return;
+    }
+    Summary group;
+    for (auto const& result : results) {
+      group.add(result);
+    }
+    begin_event("after_test_group")
+        .field("test", join_str(results.front().test->full_name, "::"))
+        .key("summary");
+    group.write(json);
+    end_event();
+  }
+
+  void exit_namespace(std::string_view name) override {
+    if (output == nullptr) {
+      return;
+    }
+    begin_event("exit_namespace").field("name", name);
+    end_event();
+  }
+
+  void after_run() override {
+    if (output == nullptr) {
+      return;
+    }
+    begin_event("after_run").key("summary");
+    summary.write(json);
+    write_assertion_sites(json);
+    end_event();
+  }
 };
 }  // namespace rsl::testing::_impl
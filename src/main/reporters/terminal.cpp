@@ -1,50 +1,189 @@
 #include <rsl/testing/output.hpp>
 #include <array>
-#include <print>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string>
 #include <rsl/testing/assert.hpp>
+#include <rsl/testing/util.hpp>
 #include "rsl/testing/result.hpp"
 
 namespace rsl::testing::_impl {
-class[[= rename("plain")]] ConsoleReporter : public Reporter::Registrar<ConsoleReporter> {
-  std::vector<TestOutcome> test_outcomes;
-  std::vector<TestOutcome> run_outcomes;
-  std::vector<TestOutcome> assertion_outcomes;
-public:
-  void before_run(TestNamespace const& tests) override {
-    std::print("Running {} tests...\n", tests.count());
+namespace {
+bool const must_colorize = true;
+auto const color = std::array{must_colorize ? "\033[32m" : "", must_colorize ? "\033[31m" : ""};
+char const* const reset = must_colorize ? "\033[0m" : "";
+
+std::string format_time(double ns) {
+  if (ns < 1e3) {
+    return std::format("{:.2f} ns", ns);
   }
-  void before_test(TestCase const& test) override { std::print("[ RUN      ] {}\n", test.name); }
-  void after_test(Result const& result) override {
-    bool const must_colorize = true;
-    auto const color = std::array{must_colorize ? "\033[32m" : "", must_colorize ? "\033[31m" : ""};
-    const char* const reset = must_colorize ? "\033[0m" : "";
-
-    if (result.outcome == TestOutcome::PASS) {
-      std::print("[{}       OK {}] {} ({:.3f} ms)\n",
-                 color[0],
-                 reset,
-                 result.name,
-                 result.duration_ms);
+  if (ns < 1e6) {
+    return std::format("{:.2f} us", ns / 1e3);
+  }
+  if (ns < 1e9) {
+    return std::format("{:.2f} ms", ns / 1e6);
+  }
+  return std::format("{:.2f} s", ns / 1e9);
+}
+
+std::string escape_bytes(std::span<std::uint8_t const> bytes) {
+  std::string result;
+  for (auto byte : bytes) {
+    if (byte == '\\' || byte == '"') {
+      result += '\\';
+      result += char(byte);
+    } else if (byte >= 0x20 && byte < 0x7f) {
+      result += char(byte);
     } else {
-      std::print("[{}   FAILED {}] {} ({:.3f} ms)\n",
-                 color[1],
-                 reset,
-                 result.name,
-                 result.duration_ms);
-      std::print("{}ERROR{}: {}\n", color[1], reset, result.failure->message);
-      std::print("==== {}stdout{} ====\n{}\n", color[1], reset, result.stdout);
-      std::print("==== {}stderr{} ====\n{}\n", color[1], reset, result.stderr);
+      result += std::format("\\x{:02x}", byte);
+    }
+  }
+  return result;
+}
+
+void print_benchmark(Output& out, BenchmarkResult const& benchmark) {
+  out.printf("             min {} | median {} | mean {} +- {} | {:.0f} it/s ({} x {})\n",
+             format_time(benchmark.min_ns),
+             format_time(benchmark.median_ns),
+             format_time(benchmark.mean_ns),
+             format_time(benchmark.stddev_ns),
+             benchmark.throughput(),
+             benchmark.samples,
+             benchmark.iterations);
+}
+
+void print_allocations(Output& out, AllocationResult const& allocations) {
+  out.printf("             {} allocations | {} bytes | peak {} bytes\n",
+             allocations.count,
+             allocations.bytes,
+             allocations.peak);
+}
+
+void print_counters(Output& out, PerfResult const& counters) {
+  out.printf("             {:.3f} ms user | {:.3f} ms system | {} faults ({} major) | {} context "
+             "switches ({} involuntary)\n",
+             counters.user_ms,
+             counters.system_ms,
+             counters.minor_faults + counters.major_faults,
+             counters.major_faults,
+             counters.voluntary_switches + counters.involuntary_switches,
+             counters.involuntary_switches);
+  if (counters.cycles && counters.instructions) {
+    out.printf("             {} cycles | {} instructions ({:.2f} IPC)",
+               *counters.cycles,
+               *counters.instructions,
+               counters.instructions_per_cycle());
+    if (counters.cache_misses) {
+      out.printf(" | {} cache misses", *counters.cache_misses);
+    }
+    if (counters.branch_misses) {
+      out.printf(" | {} branch misses", *counters.branch_misses);
+    }
+    out.printf("\n");
+  }
+}
+
+void print_fuzz(Output& out, FuzzResult const& fuzz, bool failed) {
+  out.printf("             {} runs in {:.0f} ms ({:.0f} exec/s) | corpus {} | {} features | "
+             "seed {}\n",
+             fuzz.runs,
+             fuzz.duration_ms,
+             fuzz.execs_per_second(),
+             fuzz.corpus_size,
+             fuzz.features,
+             fuzz.seed);
+  if (failed && !fuzz.crash_arguments.empty()) {
+    out.printf("             failing input: {}\n", fuzz.crash_arguments);
+  } else if (failed) {
+    out.printf("             failing input ({} bytes): \"{}\"\n",
+               fuzz.crash.size(),
+               escape_bytes(fuzz.crash));
+  }
+  if (failed && !fuzz.crash_file.empty()) {
+    out.printf("             saved to {}\n", fuzz.crash_file);
+  }
+}
+
+void print_result(Output& out, Result const& result) {
+  if (result.outcome == TestOutcome::PASS) {
+    out.printf("[{}       OK {}] {} ({:.3f} ms)\n",
+               color[0],
+               reset,
+               result.name(),
+               result.duration_ms);
+  } else {
+    out.printf("[{}   FAILED {}] {} ({:.3f} ms)\n",
+               color[1],
+               reset,
+               result.name(),
+               result.duration_ms);
+    for (auto const& failure : result.failures) {
+      out.printf("{}ERROR{}: {}\n", color[1], reset, failure.message());
     }
-    for (auto const& [file, coverage] : result.coverage) {
-      std::println("Reached {} lines in file {}", coverage.size(), file);
+    if (!result.exception.empty()) {
+      out.printf("{}ERROR{}: {}\n", color[1], reset, result.exception);
     }
-    run_outcomes.push_back(result.outcome);
-    for (auto const& assertion : result.assertions) {
-      assertion_outcomes.push_back(assertion.success ? TestOutcome::PASS : TestOutcome::FAIL);
+    out.printf("==== {}stdout{} ====\n{}\n", color[1], reset, result.stdout);
+    out.printf("==== {}stderr{} ====\n{}\n", color[1], reset, result.stderr);
+  }
+  if (result.benchmark) {
+    print_benchmark(out, *result.benchmark);
+  }
+  if (result.fuzz) {
+    print_fuzz(out, *result.fuzz, result.outcome == TestOutcome::FAIL);
+  }
+  if (result.allocations) {
+    print_allocations(out, *result.allocations);
+  }
+  if (result.counters) {
+    print_counters(out, *result.counters);
+  }
+}
+
+struct Counts {
+  std::size_t pass = 0;
+  std::size_t skip = 0;
+  std::size_t fail = 0;
+
+  void add(TestOutcome outcome) {
+    switch (outcome) {
+      case TestOutcome::FAIL: ++fail; break;
+      case TestOutcome::PASS: ++pass; break;
+      case TestOutcome::SKIP: ++skip; break;
     }
   }
 
-  void after_test_group(std::span<Result> results) override {
+  [[nodiscard]] std::size_t total() const { return pass + skip + fail; }
+
+  void print(Output& out, std::string_view label) const {
+    out.printf("| {:<10} | {}{:^4}{} | {:^4} | {}{:^4}{} || {:^5} |\n",
+               label,
+               color[0],
+               pass,
+               reset,
+               skip,
+               color[1],
+               fail,
+               reset,
+               total());
+  }
+};
+
+// outcomes of tests, test cases and assertions
+struct Summary {
+  Counts tests;
+  Counts cases;
+  Counts assertions;
+
+  void add(Result const& result) {
+    cases.add(result.outcome);
+    assertions.pass += result.assertions_passed;
+    assertions.fail += result.assertions_failed;
+  }
+
+  void add_group(std::span<Result> results) {
     bool skipped = true;
     bool success = true;
     for (auto const& result : results) {
@@ -54,44 +193,124 @@ public:
       skipped = false;
       success &= result.outcome == TestOutcome::PASS;
     }
-    test_outcomes.push_back(skipped ? TestOutcome::SKIP
-                                    : (success ? TestOutcome::PASS : TestOutcome::FAIL));
-  }
-
-  static void print_outcomes(std::span<TestOutcome> outcomes, std::string_view label) {
-    std::size_t fail = 0;
-    std::size_t pass = 0;
-    std::size_t skip = 0;
-    for (auto r : outcomes) {
-      switch (r) {
-        case TestOutcome::FAIL: ++fail; continue;
-        case TestOutcome::PASS: ++pass; continue;
-        case TestOutcome::SKIP: ++skip; continue;
-      }
-    }
-    
-    bool const must_colorize = true;
-    auto const color = std::array{must_colorize ? "\033[32m" : "", must_colorize ? "\033[31m" : ""};
-    const char* const reset = must_colorize ? "\033[0m" : "";
-    
-    std::println("| {:<10} | {}{:^4}{} | {:^4} | {}{:^4}{} || {:^5} |",
-      label, color[0], pass, reset, skip, color[1], fail, reset, pass+skip+fail);
+    tests.add(skipped ? TestOutcome::SKIP : (success ? TestOutcome::PASS : TestOutcome::FAIL));
+  }
+
+  void print(Output& out) const {
+    out.print("\n=== Summary ===\n");
+    out.print("+------------+------+------+------++-------+\n");
+    out.print("|  Counter   | Pass | Skip | Fail || Total |\n");
+    out.print("+------------+------+------+------++-------+\n");
+    tests.print(out, "Tests");
+    cases.print(out, "Test Cases");
+    assertions.print(out, "Assertions");
+    out.print("+------------+------+------+------++-------+\n");
+  }
+};
+}  // namespace
+
+class[[= rename("plain")]] ConsoleReporter : public Reporter::Registrar<ConsoleReporter> {
+  Output* out = nullptr;
+  Summary summary;
+
+public:
+  void attach(Output& output) override { out = &output; }
+
+  void before_run(TestNamespace const& tests) override {
+    out->printf("Running {} tests...\n", tests.count());
+  }
+  void before_test(TestCase const& test) override { out->printf("[ RUN      ] {}\n", test.name()); }
+  void after_test(Result const& result) override {
+    print_result(*out, result);
+    summary.add(result);
   }
 
+  void after_test_group(std::span<Result> results) override { summary.add_group(results); }
+
   void after_run() override {
-    std::println("\n=== Summary ===");
-    
-    std::puts("+------------+------+------+------++-------+");
-    std::puts("|  Counter   | Pass | Skip | Fail || Total |");
-    std::puts("+------------+------+------+------++-------+");
-    print_outcomes(test_outcomes, "Tests");
-    print_outcomes(run_outcomes, "Test Cases");
-    print_outcomes(assertion_outcomes, "Assertions");
-    std::puts("+------------+------+------+------++-------+");
+    summary.print(*out);
+    out->flush();
   }
 
   // [[nodiscard]] bool colorize() const override {
   //   return libassert::isatty(libassert::stderr_fileno);
   // }
 };
+
+//? redraws a single status line and only prints details of failed cases
+//? outputs that are not a terminal only get the final status line
+class[[= rename("progress")]] ProgressReporter : public Reporter::Registrar<ProgressReporter> {
+  static constexpr auto redraw_interval = std::chrono::milliseconds(50);
+
+  Output* out = nullptr;
+  Summary summary;
+  bool terminal = false;
+  std::string current;  // test being run
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point last_draw;
+
+  void draw_status() {
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    out->printf("{}{} cases | {}{} passed{} | {}{} failed{} | {} skipped | {:.1f} s | {}",
+                terminal ? "\r\033[2K" : "",
+                summary.cases.total(),
+                color[0],
+                summary.cases.pass,
+                reset,
+                summary.cases.fail != 0 ? color[1] : "",
+                summary.cases.fail,
+                summary.cases.fail != 0 ? reset : "",
+                summary.cases.skip,
+                elapsed.count(),
+                current);
+    out->flush();
+    last_draw = std::chrono::steady_clock::now();
+  }
+
+  void clear_status() {
+    if (terminal) {
+      out->print("\r\033[2K");
+    }
+  }
+
+public:
+  void attach(Output& output) override {
+    out      = &output;
+    terminal = output.is_terminal();
+  }
+
+  void before_run(TestNamespace const& tests) override {
+    start = last_draw = std::chrono::steady_clock::now();
+  }
+
+  void before_test_group(Test const& test) override {
+    if (terminal) {
+      current = join_str(test.full_name, "::");
+    }
+  }
+
+  void before_test(TestCase const& test) override {}
+  void after_test(Result const& result) override {
+    summary.add(result);
+    if (result.outcome == TestOutcome::FAIL) {
+      clear_status();
+      print_result(*out, result);
+    }
+
+    if (terminal && (result.outcome == TestOutcome::FAIL ||
+                     std::chrono::steady_clock::now() - last_draw >= redraw_interval)) {
+      draw_status();
+    }
+  }
+
+  void after_test_group(std::span<Result> results) override { summary.add_group(results); }
+
+  void after_run() override {
+    current.clear();
+    draw_status();
+    out->print("\n");
+    summary.print(*out);
+    out->flush();
+  }
+};
 }  // namespace rsl::testing::_impl
@@ -1,33 +1,147 @@
-#include <rsl/serializer/xml/annotations.hpp>
-#include <vector>
+#include <cstddef>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 
 #include <rsl/testing/output.hpp>
-#include <rsl/xml>
+#include <rsl/testing/util.hpp>
+
+#include "xml_writer.hpp"
 
 namespace rsl::testing::_impl {
-struct testcase {
-  [[=xml::attribute]] std::string name;
-  [[=xml::attribute]] double time;
-  [[=xml::raw]] std::optional<std::string> failure;
-};
+//? JUnit puts the totals of a suite into its start tag, so every test group is written
+//? as its own testsuite once all of its results are known
+class[[= rename("junit")]] JUnitXmlReporter : public Reporter::Registrar<JUnitXmlReporter> {
+  std::optional<_xml_impl::XmlWriter> xml;
 
-struct testsuite {
-  std::vector<testcase> tests;
-};
+  template <typename T>
+  void property(std::string_view name, T const& value) {
+    xml->start("property").attribute("name", name).attribute("value", value).end();
+  }
+
+  void write_properties(Result const& result) {
+    xml->start("properties");
+    if (auto const& allocations = result.allocations) {
+      property("allocations", allocations->count);
+      property("allocated_bytes", allocations->bytes);
+      property("peak_heap_bytes", allocations->peak);
+    }
+    if (auto const& counters = result.counters) {
+      property("user_ms", counters->user_ms);
+      property("system_ms", counters->system_ms);
+      property("page_faults", counters->minor_faults + counters->major_faults);
+      property("context_switches", counters->voluntary_switches + counters->involuntary_switches);
+      if (counters->cycles) {
+        property("cycles", *counters->cycles);
+      }
+      if (counters->instructions) {
+        property("instructions", *counters->instructions);
+      }
+      if (counters->cache_misses) {
+        property("cache_misses", *counters->cache_misses);
+      }
+      if (counters->branch_misses) {
+        property("branch_misses", *counters->branch_misses);
+      }
+    }
+    xml->end();
+  }
+
+  void write_case(Result const& result, std::string const& classname) {
+    xml->start("testcase")
+        .attribute("name", result.name())
+        .attribute("classname", classname)
+        .attribute("time", result.duration_ms / 1000.);
+
+    if (result.allocations || result.counters) {
+      write_properties(result);
+    }
+
+    switch (result.outcome) {
+      using enum TestOutcome;
+      case PASS: break;
+      case FAIL:
+        if (!result.failures.empty()) {
+          // JUnit has room for a single failure per test case
+          std::string text;
+          for (auto const& failure : result.failures) {
+            text += failure.message();
+          }
+          xml->start("failure")
+              .attribute("message", result.failures.front().message())
+              .text(text)
+              .end();
+        } else {
+          xml->start("error").attribute("message", result.exception).text(result.exception).end();
+        }
+        break;
+      case SKIP: xml->start("skipped").end(); break;
+    }
+
+    if (!result.stdout.empty()) {
+      xml->element("system-out", result.stdout);
+    }
+    if (!result.stderr.empty()) {
+      xml->element("system-err", result.stderr);
+    }
+    xml->end();
+  }
 
-class [[=rename("junit")]] JUnitXmlReporter : public Reporter::Registrar<JUnitXmlReporter> {
-  testsuite suite;
 public:
+  void attach(Output& output) override { xml.emplace(output); }
+
+  void before_run(TestNamespace const& tests) override {
+    if (!xml) {
+      return;
+    }
+    xml->start("testsuites");
+    xml->flush();
+  }
+
   void before_test(TestCase const& test) override {}
-  void after_test(Result const& result) override {
-    auto node = testcase{.name=std::string(result.name), .time=result.duration_ms / 1000.};
-    if (result.outcome == TestOutcome::FAIL) {
-      node.failure = result.failure->message + "\n";
+  void after_test(Result const& result) override {}
+
+  void after_test_group(std::span<Result> results) override {
+    if (!xml || results.empty()) {
+      return;
+    }
+
+    std::size_t failures = 0;
+    std::size_t errors   = 0;
+    std::size_t skipped  = 0;
+    double time          = 0;
+    for (auto const& result : results) {
+      if (result.outcome == TestOutcome::FAIL) {
+        ++(!result.failures.empty() ? failures : errors);
+      } else if (result.outcome == TestOutcome::SKIP) {
+        ++skipped;
+      }
+      time += result.duration_ms / 1000.;
     }
-    suite.tests.push_back(node);
+
+    auto const& full_name = results.front().test->full_name;
+    auto classname        = join_str(full_name, ".");
+    xml->start("testsuite")
+        .attribute("name", join_str(full_name, "::"))
+        .attribute("tests", results.size())
+        .attribute("failures", failures)
+        .attribute("errors", errors)
+        .attribute("skipped", skipped)
+        .attribute("time", time);
+    for (auto const& result : results) {
+      write_case(result, classname);
+    }
+    xml->end();
+    xml->flush();
   }
 
-  void finalize(Output& target) override { target.print(rsl::to_xml(suite)); }
+  void after_run() override {
+    if (!xml) {
+      return;
+    }
+    xml->end();
+    xml->flush();
+  }
 };
-}  // namespace rsl::testing::_impl
\ No newline at end of file
+}  // namespace rsl::testing::_impl
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <format>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <rsl/testing/output.hpp>
+
+namespace rsl::testing::_xml_impl {
+//? writes elements as soon as they are started so reports never need to be held in memory
+//? output is buffered until `flush`, reporters flush once per result
+class XmlWriter {
+  Output* output;
+  std::string buffer;
+  std::vector<std::string_view> elements;  // names of all open elements
+  bool in_start_tag = false;               // attributes may still be added
+  bool has_text     = false;               // the innermost element has text content
+
+  void indent() { buffer.append(elements.size() * 2, ' '); }
+
+public:
+  explicit XmlWriter(Output& output) : output(&output) {
+    buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+  }
+
+  static void escape(std::string& out, std::string_view text) {
+    for (char chr : text) {
+      switch (chr) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        case '\'': out += "&apos;"; break;
+        case '\t':
+        case '\n':
+        case '\r': out += chr; break;
+        default:
+          // other control characters cannot be represented in XML 1.0
+          if (static_cast<unsigned char>(chr) >= 0x20) {
+            out += chr;
+          }
+      }
+    }
+  }
+
+  // `name` must outlive the element
+  XmlWriter& start(std::string_view name) {
+    if (in_start_tag) {
+      buffer += ">\n";
+    }
+    indent();
+    buffer += '<';
+    buffer += name;
+    elements.push_back(name);
+    in_start_tag = true;
+    return *this;
+  }
+
+  template <typename T>
+  XmlWriter& attribute(std::string_view name, T const& value) {
+    buffer += ' ';
+    buffer += name;
+    buffer += "=\"";
+    if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+      escape(buffer, value);
+    } else {
+      escape(buffer, std::format("{}", value));
+    }
+    buffer += '"';
+    return *this;
+  }
+
+  XmlWriter& text(std::string_view content) {
+    buffer += '>';
+    in_start_tag = false;
+    has_text     = true;
+    escape(buffer, content);
+    return *this;
+  }
+
+  void end() {
+    auto name = elements.back();
+    elements.pop_back();
+    if (in_start_tag) {
+      buffer += "/>\n";
+      in_start_tag = false;
+      return;
+    }
+    if (!has_text) {
+      indent();
+    }
+    has_text = false;
+    buffer += "</";
+    buffer += name;
+    buffer += ">\n";
+  }
+
+  // element with text content only
+  void element(std::string_view name, std::string_view content) {
+    start(name).text(content).end();
+  }
+
+  void flush() {
+    if (!buffer.empty()) {
+      output->print(buffer);
+      buffer.clear();
+    }
+  }
+};
+}  // namespace rsl::testing::_xml_impl
@@ -0,0 +1,46 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#  include <fstream>
+#  include <iterator>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace rsl::testing::_testing_impl {
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const& path) {
+  auto file = std::ifstream(path, std::ios::binary);
+  buffer.assign(std::istreambuf_iterator<char>(file), {});
+  data_ = buffer.data();
+  size_ = buffer.size();
+}
+
+MappedFile::~MappedFile() = default;
+#else
+MappedFile::MappedFile(std::string const& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat info{};
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void* mapping = mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      data_ = static_cast<char const*>(mapping);
+      size_ = std::size_t(info.st_size);
+    }
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+#endif
+}  // namespace rsl::testing::_testing_impl
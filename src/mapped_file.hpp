@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace rsl::testing::_testing_impl {
+// read-only view of a whole file, empty if the file does not exist
+class MappedFile {
+  char const* data_ = nullptr;
+  std::size_t size_ = 0;
+#ifdef _WIN32
+  std::string buffer;
+#endif
+
+public:
+  MappedFile() = default;
+  explicit MappedFile(std::string const& path);
+  MappedFile(MappedFile const&)            = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+  ~MappedFile();
+
+  [[nodiscard]] std::string_view view() const { return {data_, size_}; }
+};
+}  // namespace rsl::testing::_testing_impl
@@ -2,8 +2,18 @@
 #include <ranges>
 #include <vector>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <algorithm>
 #include <chrono>
+#include <format>
+#include <optional>
 #include <print>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include <rsl/source_location>
 #include <rsl/testing/assert.hpp>
@@ -13,43 +23,56 @@
 #include <rsl/testing/util.hpp>
 
 #include <cpptrace/basic.hpp>
-#include <cpptrace/utils.hpp>
 
+#include "benchmark.hpp"
 #include "capture.hpp"
+#include "counters.hpp"
+#include "coverage_table.hpp"
+#include "fuzz.hpp"
+#include "history.hpp"
+#include "impact.hpp"
+#include "schedule.hpp"
+#include "alloc/allocations.hpp"
 #include "coverage/coverage.hpp"
 
 namespace {
-void cleanup_frames(cpptrace::stacktrace& trace, std::string_view test_name) {
-  std::vector<cpptrace::stacktrace_frame> frames;
-  for (auto const& frame : trace.frames | std::views::drop(1)) {
-    frames.push_back(frame);
-    if (cpptrace::prune_symbol(frame.symbol) == test_name) {
-      break;
-    }
-  }
-  trace.frames = frames;
-}
-
 void failure_handler(libassert::assertion_info const& info) {
-  // libassert::enable_virtual_terminal_processing_if_needed();  // for terminal colors on windows
-  constexpr bool Colorize = false;
-  auto width              = libassert::terminal_width(libassert::stderr_fileno);
-  const auto& scheme  = Colorize ? libassert::get_color_scheme() : libassert::color_scheme::blank;
-  std::string message = std::string(info.action()) + " at " + info.location() + ":";
-  if (info.message) {
-    message += " " + *info.message;
-  }
-  message += "\n";
-  message +=
-      info.statement(scheme) + info.print_binary_diagnostics(width, scheme) +
-      info.print_extra_diagnostics(width, scheme);  // + info.print_stacktrace(width, scheme);
-
-  auto trace = info.get_stacktrace();
-  cleanup_frames(trace, rsl::testing::_testing_impl::assertion_counter().test_name);
-  message += trace.to_string(Colorize);
-  throw rsl::testing::assertion_failure(
-      message,
+  //? many failures are expected or never shown, so this only copies what libassert computed
+  //? anyway. Formatting and symbolization are left to assertion_failure::message
+  auto failure = rsl::testing::assertion_failure(
       rsl::source_location(info.file_name, info.function, info.line));
+
+  failure.action     = info.action();
+  failure.macro      = info.macro_name;
+  failure.expression = info.expression_string;
+  failure.note       = info.message.value_or("");
+  if (auto const& binary = info.binary_diagnostics) {
+    failure.diagnostics.emplace_back(binary->left_expression, binary->left_stringification);
+    failure.diagnostics.emplace_back(binary->right_expression, binary->right_stringification);
+  }
+  for (auto const& extra : info.extra_diagnostics) {
+    failure.diagnostics.emplace_back(std::string(extra.expression), extra.stringification);
+  }
+  failure.trace.assign_range(info.get_raw_trace().frames);
+
+  auto& tracker     = rsl::testing::_testing_impl::assertion_counter();
+  failure.test_name = tracker.test_name;
+  if (std::exchange(tracker.soft, false)) {
+    // CHECK, keep going
+    auto site = std::ranges::find_if(tracker.sites, [&](auto const& other) {
+      return other.line == failure.sloc.line && other.file == failure.sloc.file;
+    });
+    if (site == tracker.sites.end()) {
+      auto const line = std::uint_least32_t(failure.sloc.line);
+      site            = tracker.sites.insert(site, {failure.sloc.file, line, 0});
+    }
+    if (++site->count > tracker.traces_per_site) {
+      failure.trace = {};
+    }
+    tracker.failures.push_back(std::move(failure));
+    return;
+  }
+  throw failure;
 }
 
 void print_tests(rsl::testing::TestNamespace const& current, std::size_t indent = 0) {
@@ -62,7 +85,7 @@ void print_tests(rsl::testing::TestNamespace const& current, std::size_t indent
   for (auto const& test : current.tests) {
     std::println("{}- {}", current_indent, test.name);
     for (auto const& run : test.get_tests()) {
-      std::println("{}- {}", std::string((indent + 1) * 2, ' '), run.name);
+      std::println("{}- {}", std::string((indent + 1) * 2, ' '), run.name());
     }
   }
 }
@@ -73,48 +96,127 @@ void Reporter::list_tests(TestNamespace const& tests) {
   print_tests(tests);
 }
 
-bool TestRoot::run(Reporter* reporter) {
+bool TestRoot::run(Reporter* reporter, RunConfig const& config) {
   libassert::set_failure_handler(failure_handler);
-  std::println("failure handler set");
   reporter->before_run(*this);
-  bool status = TestNamespace::run(reporter);
+  _testing_impl::coverage_table().clear();
+
+  _testing_impl::benchmark_settings() = {.enabled       = config.benchmark,
+                                         .samples       = config.benchmark_samples,
+                                         .min_sample_ms = config.benchmark_min_time};
+  _testing_impl::assertion_settings() = {.mode  = config.assertion_tracking,
+                                         .limit = config.assertion_limit,
+                                         .sites = config.assertion_sites};
+  _testing_impl::fuzz_settings()      = {.enabled  = config.fuzz,
+                                         .runs     = config.fuzz_runs,
+                                         .time_s   = config.fuzz_time,
+                                         .max_len  = config.fuzz_max_len,
+                                         .seed     = config.fuzz_seed,
+                                         .corpus   = config.fuzz_corpus,
+                                         .minimize = config.fuzz_minimize,
+                                         .jobs     = config.fuzz_jobs};
+  if (config.fuzz_jobs == 0) {
+    _testing_impl::fuzz_settings().jobs =
+        std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t{1});
+  }
+
+  // redirection is process wide, concurrently running cases would capture each other's output
+  auto const threaded =
+      !config.isolate && config.jobs != 1 && _rsl_test_run_with_coverage == nullptr;
+  capture_output()               = {.out = config.capture && !threaded,
+                                    .err = config.capture_stderr && !threaded};
+  _testing_impl::perf_counters() = config.perf_counters;
+
+  std::optional<_testing_impl::History> history;
+  if (!config.history.empty()) {
+    history.emplace(config.history);
+  }
+
+  std::optional<_testing_impl::ImpactIndex> impact;
+  if (!config.impact_index.empty()) {
+    impact.emplace(config.impact_index);
+  }
+
+  // the index can only be updated if this is a coverage run
+  auto* impact_sink = impact && _rsl_test_run_with_coverage != nullptr ? &*impact : nullptr;
+  auto schedule     = _testing_impl::Schedule(*this, history ? &*history : nullptr, impact_sink);
+  if (!config.changes.empty()) {
+    if (impact && !impact->empty()) {
+      schedule.select_affected(*impact, config.changes);
+    } else {
+      std::println(stderr, "No test impact index available, running all tests.");
+    }
+  }
+  schedule.shard(config.shard_index, config.shard_count);
+  if (_rsl_test_allocations_start == nullptr) {
+    // without rsltest_alloc the limit would pass silently
+    Test const* warned = nullptr;
+    for (auto const& test_case : schedule.cases) {
+      auto const* test = test_case.test;
+      if (test != warned && test->max_allocations != std::numeric_limits<std::size_t>::max()) {
+        warned = test;
+        std::println(stderr,
+                     "Warning: {} sets rsl::max_allocations, link rsltest_alloc to check it.",
+                     join_str(test->full_name, "::"));
+      }
+    }
+  }
+  schedule.start(config);
+  bool status = TestNamespace::run(reporter, schedule);
   libassert::set_failure_handler(libassert::default_failure_handler);
+  if (impact) {
+    impact->save();
+  }
+  if (history) {
+    history->save();
+    if (config.history_report != 0) {
+      // stdout may carry a machine readable report
+      std::print(stderr, "{}", history->report(config.history_report));
+    }
+  }
   // TODO after_run
   reporter->after_run();
   return status;
 }
 
-bool TestNamespace::run(Reporter* reporter) {
+bool TestNamespace::run(Reporter* reporter, _testing_impl::Schedule& schedule) {
   if (!name.empty()) {
     reporter->enter_namespace(name);
   }
   bool status = true;
   for (auto& ns : children) {
-    status &= ns.run(reporter);
+    status &= ns.run(reporter, schedule);
   }
 
   for (auto& test : tests) {
-    auto runs = test.get_tests();
+    auto const* group = schedule.find(test);
+    if (group == nullptr) {
+      continue;
+    }
+
     reporter->before_test_group(test);
     std::vector<Result> results;
-    if (!test.skip()) {
-      for (auto const& test_run : test.get_tests()) {
-        auto& tracker      = _testing_impl::assertion_counter();
-        tracker.assertions = {};
-        tracker.test_name  = join_str(test.full_name, "::");
-
-        reporter->before_test(test_run);
-        auto result = test_run.run();
-        result.assertions = tracker.assertions;
+    if (!group->skipped) {
+      for (auto idx = group->first; idx < group->first + group->count; ++idx) {
+        reporter->before_test(schedule.cases[idx]);
+        auto result = schedule.take(idx);
+        status &= result.outcome != TestOutcome::FAIL;
 
         reporter->after_test(result);
-        results.push_back(result);
+        results.push_back(std::move(result));
       }
     } else {
-      reporter->before_test(TestCase{&test, +[] {}, std::string(test.name)});
+      auto base_name = +[](void const* test) {
+        return std::string(static_cast<Test const*>(test)->name);
+      };
+      reporter->before_test(TestCase{&test, +[](void const*) {}, base_name, &test});
 
       // TODO stringify skipped tests properly
-      auto result = Result{&test, std::string(test.name) + "(...)", TestOutcome::SKIP};
+      auto skipped_name = +[](void const* test) {
+        return std::string(static_cast<Test const*>(test)->name) + "(...)";
+      };
+      auto result = Result{
+          .test = &test, .describe = skipped_name, .args = &test, .outcome = TestOutcome::SKIP};
       reporter->after_test(result);
       results.push_back(result);
     }
@@ -128,46 +230,154 @@ bool TestNamespace::run(Reporter* reporter) {
 }
 
 namespace {
-void run_test(void const* test) {
-  (*static_cast<std::function<void()> const*>(test))();
-}
+struct SourceLine {
+  std::string const* file = nullptr;  // nullptr if this pc should not be reported
+  std::uint32_t line      = 0;
+};
+
+//? process-wide pc -> source line cache shared by all tests
+//? coverage runs are always serial, so this is not synchronized
+class SymbolCache {
+  std::unordered_map<std::uintptr_t, SourceLine> lines;
+  std::unordered_set<std::string> files;
+
+  SourceLine locate(cpptrace::stacktrace_frame const& frame) {
+    if (frame.filename.empty() || (int)frame.line.value() < 0) {
+      return {};
+    }
+    if (frame.filename.contains("/../include/c++/")) {
+      return {};
+    }
+    return {&*files.insert(frame.filename).first, frame.line.value()};
+  }
+
+public:
+  // symbolize all pcs not seen before in a single batch
+  void resolve(std::span<rsl::coverage::CoverageReport const> reports) {
+    std::vector<cpptrace::frame_ptr> missing;
+    for (auto const& report : reports) {
+      if (!lines.contains(report.pc)) {
+        missing.push_back(report.pc);
+      }
+    }
+    if (missing.empty()) {
+      return;
+    }
 
-auto resolve_pc(std::uintptr_t pc) {
-  auto raw_trace = cpptrace::raw_trace{{pc}};
-  auto trace     = raw_trace.resolve();
-  return trace.frames[0];
+    auto trace = cpptrace::raw_trace{missing}.resolve();
+
+    // every pc yields zero or more inlined frames followed by exactly one regular frame
+    // the first frame of each group is the innermost source location
+    std::size_t current = 0;
+    bool group_start    = true;
+    for (auto const& frame : trace.frames) {
+      if (current >= missing.size()) {
+        break;
+      }
+      if (group_start) {
+        lines[missing[current]] = locate(frame);
+      }
+      group_start = !frame.is_inline;
+      if (group_start) {
+        ++current;
+      }
+    }
+
+    // anything cpptrace could not resolve is not worth asking for again
+    for (; current < missing.size(); ++current) {
+      lines.try_emplace(missing[current]);
+    }
+  }
+
+  [[nodiscard]] SourceLine const& operator[](std::uintptr_t pc) const { return lines.at(pc); }
+};
+
+SymbolCache& symbol_cache() {
+  static SymbolCache cache;
+  return cache;
 }
 
 auto filter_coverage(rsl::coverage::CoverageReport* data, std::size_t size) {
-  std::unordered_map<std::string, std::vector<LineCoverage>> coverage;
+  auto reports = std::span(data, size);
+  auto& cache  = symbol_cache();
+  cache.resolve(reports);
 
-  for (std::size_t idx = 0; idx < size; ++idx) {
-    auto resolved = resolve_pc(data[idx].pc);
-    if (resolved.filename.empty() || (int)resolved.line.value() < 0) {
-      continue;
-    }
-    if (resolved.filename.contains("/../include/c++/")) {
+  std::unordered_map<std::string const*, std::vector<LineCoverage>> coverage;
+  for (auto const& report : reports) {
+    auto const& resolved = cache[report.pc];
+    if (resolved.file == nullptr) {
       continue;
     }
-    coverage[resolved.filename].push_back({resolved.line.value(), data[idx].hits});
+    coverage[resolved.file].push_back({resolved.line, report.hits});
   }
 
   std::vector<FileCoverage> result;
-  for (auto const& [name, cov] : coverage) {
-    result.emplace_back(name, cov);
+  result.reserve(coverage.size());
+  for (auto& [name, cov] : coverage) {
+    result.emplace_back(*name, std::move(cov));
   }
   return result;
 }
-}  // namespace
 
-Result TestCase::run() const {
-  auto ret = Result{.test = test, .name = name};
+//? counts the allocations of the calling thread while alive, if rsltest_alloc is linked in
+//? counting starts paused, only `rsl::alloc::CountingSection`s around the test itself count
+class AllocationScope {
+  std::optional<AllocationResult>* target = nullptr;
+
+public:
+  explicit AllocationScope(std::optional<AllocationResult>& result) {
+    if (_rsl_test_allocations_start != nullptr) {
+      target = &result;
+      _rsl_test_allocations_start();
+      _rsl_test_allocations_pause(true);
+    }
+  }
+
+  AllocationScope(AllocationScope const&)            = delete;
+  AllocationScope& operator=(AllocationScope const&) = delete;
+
+  ~AllocationScope() {
+    if (target == nullptr) {
+      return;
+    }
+    rsl::alloc::AllocationCounters counters;
+    _rsl_test_allocations_stop(&counters);
+    *target = AllocationResult{.count = counters.count,
+                               .bytes = counters.bytes,
+                               .peak  = counters.peak};
+  }
+};
+
+// runs the test itself, coverage instrumentation only calls this back
+void run_counted(void const* data) {
+  auto const& test_case = *static_cast<TestCase const*>(data);
+  auto counting         = rsl::alloc::CountingSection(true);
+  test_case.fnc(test_case.args);
+}
+
+Result invoke(TestCase const& test_case) {
+  auto const* test = test_case.test;
+  auto ret         = Result{.test = test, .describe = test_case.describe, .args = test_case.args};
   try {
-    // Capture _out(stdout, ret.stdout);
-    // Capture _err(stderr, ret.stderr);
+    std::optional<Capture> out;
+    std::optional<Capture> err;
+    if (capture_output().out) {
+      out.emplace(stdout, ret.stdout);
+    }
+    if (capture_output().err) {
+      err.emplace(stderr, ret.stderr);
+    }
 
-    auto t0 = std::chrono::steady_clock::now();
-    if (_rsl_test_run_with_coverage != nullptr) {
+    auto t0       = std::chrono::steady_clock::now();
+    auto counters = std::optional<_testing_impl::CounterScope>();
+    if (_testing_impl::perf_counters()) {
+      counters.emplace(ret.counters);
+    }
+    auto allocations = std::optional<AllocationScope>(std::in_place, ret.allocations);
+    if (test_case.fuzz.run != nullptr) {
+      // the fuzzer collects coverage feedback on its own
+      _testing_impl::fuzz(test_case, _testing_impl::fuzz_settings(), ret.fuzz.emplace());
+    } else if (_rsl_test_run_with_coverage != nullptr) {
       // rsltest_cov was linked in -> run with coverage
       rsl::coverage::CoverageReport* reports = nullptr;
       std::size_t report_count               = 0;
@@ -176,25 +386,26 @@ Result TestCase::run() const {
         free(reports);
       };
       try {
-        _rsl_test_run_with_coverage(run_test,
-                                    static_cast<void const*>(&fnc),
-                                    &reports,
-                                    &report_count);
+        _rsl_test_run_with_coverage(run_counted, &test_case, &reports, &report_count);
         finalize();
       } catch (...) { 
         finalize();
         throw;
       }
+    } else if (test->is_benchmark && _testing_impl::benchmark_settings().enabled) {
+      ret.benchmark = _testing_impl::measure(test_case, _testing_impl::benchmark_settings());
     } else {
-      fnc();
+      run_counted(&test_case);
     }
+    allocations.reset();
+    counters.reset();
     auto t1 = std::chrono::steady_clock::now();
 
     ret.outcome     = TestOutcome(!test->expect_failure);
     ret.duration_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
     return ret;
-  } catch (assertion_failure const& failure) {
-    ret.failure = failure;
+  } catch (assertion_failure& failure) {
+    ret.failures.push_back(std::move(failure));
   } catch (std::exception const& exc) {  //
     ret.exception += exc.what();
   } catch (std::string const& msg) {  //
@@ -208,4 +419,61 @@ Result TestCase::run() const {
   ret.outcome = TestOutcome(test->expect_failure);
   return ret;
 }
+}  // namespace
+
+std::vector<FileCoverage> instrumented_lines() {
+  if (_rsl_test_instrumented_pcs == nullptr) {
+    return {};
+  }
+
+  std::uintptr_t* pcs = nullptr;
+  std::size_t count   = 0;
+  _rsl_test_instrumented_pcs(&pcs, &count);
+
+  std::vector<rsl::coverage::CoverageReport> reports;
+  reports.reserve(count);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    reports.push_back({pcs[idx], 0});
+  }
+  free(pcs);
+  return filter_coverage(reports.data(), reports.size());
+}
+
+std::vector<FileCoverage> run_coverage() {
+  auto& table = _testing_impl::coverage_table();
+  table.add(instrumented_lines());
+  return table.lines();
+}
+
+Result TestCase::run() const {
+  auto& tracker     = _testing_impl::assertion_counter();
+  tracker.settings  = _testing_impl::assertion_settings();
+  tracker.test_name = join_str(test->full_name, "::");
+  tracker.clear();
+
+  auto ret = invoke(*this);
+  if (!tracker.failures.empty()) {
+    // soft failures happened first, a fatal one can only be the last
+    ret.failures.insert(ret.failures.begin(),
+                        std::make_move_iterator(tracker.failures.begin()),
+                        std::make_move_iterator(tracker.failures.end()));
+    tracker.failures.clear();
+    ret.outcome = TestOutcome(test->expect_failure);
+  }
+  if (ret.allocations && ret.allocations->count > test->max_allocations) {
+    // nothing was thrown, reporters must see a failed assertion rather than an error
+    auto const& sloc = test->sloc;
+    ret.failures.emplace_back(std::format("{} allocations, at most {} allowed",
+                                          ret.allocations->count,
+                                          test->max_allocations),
+                              rsl::source_location(sloc.file_name(),
+                                                   sloc.function_name(),
+                                                   sloc.line()));
+    ret.outcome = TestOutcome(test->expect_failure);
+  }
+  ret.assertions        = tracker.take();
+  ret.assertions_passed = tracker.passed;
+  ret.assertions_failed = tracker.failed;
+  return ret;
+}
 }  // namespace rsl::testing
\ No newline at end of file
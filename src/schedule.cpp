@@ -0,0 +1,191 @@
+#include "schedule.hpp"
+#include "coverage_table.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <rsl/testing/util.hpp>
+
+namespace rsl::testing::_testing_impl {
+std::string case_id(Test const& test, std::string_view case_name) {
+  // the case name already contains the test's own name and its arguments
+  auto const& full_name = test.full_name;
+  if (full_name.size() <= 1) {
+    return std::string(case_name);
+  }
+  return join_str(full_name.first(full_name.size() - 1), "::") + "::" + std::string(case_name);
+}
+
+std::string case_id(TestCase const& test_case) {
+  return case_id(*test_case.test, test_case.name());
+}
+
+Schedule::Schedule(TestNamespace const& root, History* history, ImpactIndex* impact)
+    : history(history)
+    , impact(impact) {
+  add(root);
+}
+
+void Schedule::add(TestNamespace const& ns) {
+  for (auto const& child : ns.children) {
+    add(child);
+  }
+
+  for (auto const& test : ns.tests) {
+    auto& group = groups[&test];
+    group.first = cases.size();
+    if (test.skip()) {
+      group.skipped = true;
+      continue;
+    }
+    cases.append_range(test.get_tests());
+    group.count = cases.size() - group.first;
+  }
+}
+
+std::vector<double> Schedule::expected_costs() const {
+  if (history == nullptr) {
+    return {};
+  }
+
+  // cases without history are assumed to take as long as the average known case
+  std::vector<double> cost(cases.size(), -1);
+  double known_total = 0;
+  std::size_t known  = 0;
+  for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+    if (auto const* entry = history->find(id(idx))) {
+      cost[idx] = entry->duration_ms;
+      known_total += entry->duration_ms;
+      ++known;
+    }
+  }
+  double fallback = known == 0 ? 1.0 : known_total / double(known);
+  std::ranges::replace(cost, -1.0, fallback);
+  return cost;
+}
+
+std::vector<std::size_t> Schedule::assign_shards(std::size_t count) const {
+  std::vector<std::size_t> owner(cases.size());
+  auto cost = expected_costs();
+  if (cost.empty()) {
+    for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+      owner[idx] = idx % count;
+    }
+    return owner;
+  }
+
+  // longest processing time first
+  std::vector<std::size_t> order(cases.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&](std::size_t lhs, std::size_t rhs) {
+    return cost[lhs] > cost[rhs];
+  });
+
+  std::vector<double> load(count, 0);
+  for (auto idx : order) {
+    // ties go to the lowest shard to keep the split deterministic
+    auto target = std::size_t(std::ranges::min_element(load) - load.begin());
+    owner[idx]  = target;
+    load[target] += cost[idx];
+  }
+  return owner;
+}
+
+void Schedule::retain(std::vector<bool> const& keep, bool keep_skipped) {
+  // kept[i] = number of selected cases before case i
+  std::vector<std::size_t> kept(cases.size() + 1, 0);
+  for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+    kept[idx + 1] = kept[idx] + std::size_t(keep[idx]);
+  }
+
+  std::erase_if(groups, [&](auto& entry) {
+    auto& group = entry.second;
+    if (group.skipped) {
+      group.first = kept[group.first];
+      return !keep_skipped;
+    }
+    auto last   = kept[group.first + group.count];
+    group.first = kept[group.first];
+    group.count = last - group.first;
+    return group.count == 0;
+  });
+
+  std::vector<TestCase> selected;
+  selected.reserve(kept.back());
+  std::vector<std::string> selected_ids;
+  for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+    if (!keep[idx]) {
+      continue;
+    }
+    selected.push_back(std::move(cases[idx]));
+    if (!ids.empty()) {
+      selected_ids.push_back(std::move(ids[idx]));
+    }
+  }
+  cases = std::move(selected);
+  ids   = std::move(selected_ids);
+}
+
+std::string const& Schedule::id(std::size_t index) const {
+  if (ids.empty()) {
+    ids.resize(cases.size());
+  }
+  if (ids[index].empty()) {
+    ids[index] = case_id(cases[index]);
+  }
+  return ids[index];
+}
+
+void Schedule::shard(std::size_t index, std::size_t count) {
+  if (count <= 1) {
+    return;
+  }
+  if (index >= count) {
+    throw std::invalid_argument("shard index must be smaller than shard count");
+  }
+
+  auto owner = assign_shards(count);
+  std::vector<bool> keep(cases.size());
+  for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+    keep[idx] = owner[idx] == index;
+  }
+  // report skipped tests exactly once across all shards
+  retain(keep, index == 0);
+}
+
+void Schedule::select_affected(ImpactIndex const& index, std::span<ChangedLines const> changes) {
+  auto query = ImpactIndex::Query(index, changes);
+  std::vector<bool> keep(cases.size());
+  for (std::size_t idx = 0; idx < cases.size(); ++idx) {
+    keep[idx] = query.affected(id(idx));
+  }
+  retain(keep, true);
+}
+
+void Schedule::start(RunConfig const& config) {
+  auto cost = expected_costs();
+  executor  = make_executor(config, cases, cost);
+}
+
+TestGroup const* Schedule::find(Test const& test) const {
+  auto it = groups.find(&test);
+  return it == groups.end() ? nullptr : &it->second;
+}
+
+Result Schedule::take(std::size_t index) {
+  auto result = executor->take(index);
+  if (history != nullptr) {
+    history->record(id(index), result);
+  }
+  // fuzz tests collect coverage feedback only, they stay unknown and are always affected
+  if (impact != nullptr && !result.fuzz) {
+    impact->record(id(index), result.coverage);
+  }
+  if (!result.coverage.empty()) {
+    coverage_table().add(result.coverage);
+    result.coverage = {};
+  }
+  return result;
+}
+}  // namespace rsl::testing::_testing_impl
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <rsl/testing/test.hpp>
+#include <rsl/testing/result.hpp>
+
+#include "executor.hpp"
+#include "history.hpp"
+#include "impact.hpp"
+
+namespace rsl::testing::_testing_impl {
+
+struct TestGroup {
+  std::size_t first = 0;  // index of the first case in `Schedule::cases`
+  std::size_t count = 0;
+  bool skipped      = false;
+};
+
+// stable identifier of a test case across runs
+std::string case_id(Test const& test, std::string_view case_name);
+std::string case_id(TestCase const& test_case);
+
+class Schedule {
+  std::unordered_map<Test const*, TestGroup> groups;
+  std::unique_ptr<Executor> executor;
+  History* history    = nullptr;
+  ImpactIndex* impact = nullptr;  // updated with the coverage of every case
+
+  //? ids are built from the case name, so they are only built on first use and kept
+  //? for the history lookup, the history record and the impact record of a case
+  mutable std::vector<std::string> ids;  // parallel to `cases`, empty until first used
+
+public:
+  //? cases are stored in the order reporters will see them
+  //? this is the same order `TestNamespace::run` walks the tree in
+  std::vector<TestCase> cases;
+
+  explicit Schedule(TestNamespace const& root,
+                    History* history    = nullptr,
+                    ImpactIndex* impact = nullptr);
+
+  // keep only the cases belonging to shard `index` out of `count`
+  void shard(std::size_t index, std::size_t count);
+
+  // keep only the cases affected by `changes`
+  void select_affected(ImpactIndex const& index, std::span<ChangedLines const> changes);
+
+  void start(RunConfig const& config);
+  [[nodiscard]] TestGroup const* find(Test const& test) const;
+  [[nodiscard]] Result take(std::size_t index);
+
+private:
+  void add(TestNamespace const& ns);
+  void retain(std::vector<bool> const& keep, bool keep_skipped);
+  [[nodiscard]] std::string const& id(std::size_t index) const;
+  [[nodiscard]] std::vector<double> expected_costs() const;
+  [[nodiscard]] std::vector<std::size_t> assign_shards(std::size_t count) const;
+};
+}  // namespace rsl::testing::_testing_impl
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <atomic>
 #include <print>
 
 #include <rsl/source_location>
@@ -8,6 +9,8 @@
 #include <rsl/testing/output.hpp>
 #include <rsl/testing/_testing_impl/discovery.hpp>
 
+#include "alloc/allocations.hpp"
+
 namespace rsl::testing {
 namespace _testing_impl {
 std::set<TestDef>& registry() {
@@ -16,9 +19,40 @@ std::set<TestDef>& registry() {
 }
 
 AssertionTracker& assertion_counter() {
-  static AssertionTracker counter{};
+  // one tracker per thread so tests can run concurrently
+  thread_local AssertionTracker counter{};
   return counter;
 }
+
+AssertionSettings& assertion_settings() {
+  static AssertionSettings settings{};
+  return settings;
+}
+
+namespace {
+std::atomic<AssertionSite const*>& site_list() {
+  static constinit std::atomic<AssertionSite const*> head{nullptr};
+  return head;
+}
+}  // namespace
+
+void AssertionSite::count(bool success) {
+  (success ? passed : failed).fetch_add(1, std::memory_order_relaxed);
+  if (!linked.load(std::memory_order_relaxed) && !linked.exchange(true)) {
+    auto& head = site_list();
+    next       = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(next, this, std::memory_order_release)) {}
+  }
+}
+
+AssertionSite const* assertion_sites() {
+  return site_list().load(std::memory_order_acquire);
+}
+
+void AssertionTracker::grow() {
+  auto paused = rsl::alloc::CountingSection(false);
+  assertions.reserve(std::max(assertions.capacity() * 2, std::size_t{64}));
+}
 }  // namespace _testing_impl
 
 TestNamespace::iterator::iterator(TestNamespace const& ns) {
@@ -0,0 +1,33 @@
+#define RSLTEST_SKIP
+#include <rsl/test>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace testing::allocations {
+// assertions are stored by the runner, which must not count against the test
+[[= rsl::test, = rsl::max_allocations(0)]]
+void stays_under_limit() {
+  auto values = std::array<std::size_t, 128>{};
+  for (std::size_t idx = 0; idx < values.size(); ++idx) {
+    values[idx] = idx * 2;
+    ASSERT(values[idx] == idx * 2);
+  }
+}
+
+[[= rsl::test, = rsl::max_allocations(1)]]
+void single_allocation_at_limit() {
+  auto value = std::make_unique<int>(42);
+  rsl::testing::do_not_optimize(value);
+  ASSERT(*value == 42);
+}
+
+[[= rsl::test, = rsl::expect_failure, = rsl::max_allocations(1)]]
+void exceeds_limit() {
+  auto nested = std::vector<std::vector<int>>(4, std::vector<int>(4));
+  rsl::testing::do_not_optimize(nested);
+}
+}  // namespace testing::allocations
+
+RSLTEST_ENABLE_NS(testing::allocations)
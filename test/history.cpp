@@ -0,0 +1,114 @@
+#define RSLTEST_SKIP
+#include <rsl/test>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "history.hpp"
+
+namespace testing::history {
+using rsl::testing::Result;
+using rsl::testing::TestOutcome;
+using rsl::testing::_testing_impl::History;
+
+struct TemporaryFile {
+  std::string path;
+
+  explicit TemporaryFile(std::string_view name)
+      : path((std::filesystem::temp_directory_path() / name).string()) {
+    std::filesystem::remove(path);
+  }
+  TemporaryFile(TemporaryFile const&)            = delete;
+  TemporaryFile& operator=(TemporaryFile const&) = delete;
+  ~TemporaryFile() { std::filesystem::remove(path); }
+
+  [[nodiscard]] std::string contents() const {
+    auto file = std::ifstream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), {}};
+  }
+};
+
+Result make_result(double duration_ms, TestOutcome outcome = TestOutcome::PASS) {
+  return Result{.test = nullptr, .outcome = outcome, .duration_ms = duration_ms};
+}
+
+[[= rsl::test]]
+void round_trip() {
+  auto file = TemporaryFile("rsltest_history_round_trip");
+  {
+    auto history = History(file.path);
+    history.record("ns::first", make_result(1.5));
+    history.record("ns::first", make_result(2.5));
+    history.record("ns::second(1)", make_result(4, TestOutcome::FAIL));
+    history.record("ns::skipped", make_result(1, TestOutcome::SKIP));
+    history.save();
+  }
+
+  auto history      = History(file.path);
+  auto const* first = history.find("ns::first");
+  ASSERT(first != nullptr);
+  ASSERT(first->id == "ns::first");
+  ASSERT(first->runs == 2);
+  ASSERT(first->duration_ms == 2.5);
+  ASSERT(first->baseline_ms == 1.5);
+
+  auto const* second = history.find("ns::second(1)");
+  ASSERT(second != nullptr);
+  ASSERT(second->runs == 1);
+  ASSERT(second->outcome == TestOutcome::FAIL);
+
+  ASSERT(history.find("ns::skipped") == nullptr);
+  ASSERT(history.find("ns::unknown") == nullptr);
+}
+
+[[= rsl::test]]
+void shards_append_to_one_file() {
+  auto file = TemporaryFile("rsltest_history_shards");
+  {
+    // both shards load the empty file before either of them saves
+    auto shard_a = History(file.path);
+    auto shard_b = History(file.path);
+    shard_a.record("a", make_result(1));
+    shard_b.record("b", make_result(2));
+    shard_a.save();
+    shard_b.save();
+  }
+
+  auto contents = file.contents();
+  ASSERT(contents.starts_with("RSLHIST1"));
+  ASSERT(contents.find("RSLHIST1", 1) == std::string::npos);
+
+  auto history = History(file.path);
+  ASSERT(history.find("a") != nullptr);
+  ASSERT(history.find("b") != nullptr);
+}
+
+[[= rsl::test]]
+void compaction_keeps_records_of_other_shards() {
+  auto file = TemporaryFile("rsltest_history_compaction");
+  {
+    auto shard = History(file.path);
+    auto large = History(file.path);
+    shard.record("other", make_result(3));
+    for (int run = 0; run < 1100; ++run) {
+      large.record("hot", make_result(run));
+    }
+    shard.save();  // appended after `large` loaded the file
+    large.save();  // compacts
+  }
+
+  auto history    = History(file.path);
+  auto const* hot = history.find("hot");
+  ASSERT(hot != nullptr);
+  ASSERT(hot->duration_ms == 1099);
+  ASSERT(history.find("other") != nullptr);
+#ifndef _WIN32
+  ASSERT(hot->runs == 2);  // baseline and most recent sample
+#endif
+}
+}  // namespace testing::history
+
+RSLTEST_ENABLE_NS(testing::history)